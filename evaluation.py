@@ -53,6 +53,7 @@ class Evaluation(TypedDict):
     improved_solution: bool
     exact_size: int | None
     exact_runtime_ms: float | None
+    stats: dict | None
 
 
 def main():
@@ -137,6 +138,7 @@ def evaluate(
     stdout_path = (
         logs_dir / f"out-{dataset_name.rsplit('/', 1)[-1]}-{int(time.time())}-{uuid.uuid4()}.txt"
     )
+    stats_path = stdout_path.with_suffix(".json")
     try:
         with open(stdout_path, "ab+") as stdout:
             process = subprocess.run(
@@ -154,6 +156,8 @@ def evaluate(
                         alpha,
                         "-g",
                         dataset_name,
+                        "--stats-json",
+                        stats_path,
                     ],
                 ),
                 stdout=stdout,
@@ -176,21 +180,14 @@ def evaluate(
     if process.returncode != 0:
         print(f"[Error] see ${str(stdout_path)}")
         return None
-    with open(stdout_path, "r", encoding="utf-8") as stdout:
-        output = stdout.read()
-    initial_size = None
-    solution_size = None
-    match = re.search(r"Initial solution size = (\d+)", output, re.MULTILINE)
-    if match is not None:
-        initial_size = int(match.group(1))
-    match = re.search(r"Result size = (\d+)", output, re.MULTILINE)
-    if match is not None:
-        solution_size = int(match.group(1))
+    with open(stats_path, "r", encoding="utf-8") as f:
+        stats = json.load(f)
+    initial_size = stats.get("initial_size")
+    solution_size = stats.get("solution_size")
     print("solution size", solution_size)
     runtime_ms = None
-    match = re.search(r"^\[timer\] ([\d\.]+) microseconds$", output, re.MULTILINE)
-    if match is not None:
-        runtime_ms = float(match.group(1)) / 1000
+    if "runtime_us" in stats:
+        runtime_ms = stats["runtime_us"] / 1000
 
     improved_solution = False
     if initial_size != solution_size:
@@ -221,6 +218,7 @@ def evaluate(
         solution_size=solution_size,
         exact_size=exact_size,
         exact_runtime_ms=exact_runtime_ms,
+        stats=stats,
     )
 
 
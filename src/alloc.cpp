@@ -0,0 +1,107 @@
+#include "alloc.hpp"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <string>
+
+namespace gm {
+
+using namespace std;
+
+namespace {
+
+// stored in front of every array, which keeps the array 64 byte aligned
+struct alignas(64) Header {
+    size_t bytes; // of the whole allocation, header included
+    bool mapped;
+};
+
+constexpr size_t HUGE_PAGE = size_t(1) << 21;
+constexpr int MPOL_INTERLEAVE = 3; // from <numaif.h>, which needs libnuma
+
+void warnOnce(atomic<bool> &warned, const string &message) {
+    if (!warned.exchange(true)) { cerr << "[alloc] " << message << "\n"; }
+}
+
+// bit i set for every online node i
+unsigned long onlineNodes() {
+    static const unsigned long mask = [] {
+        unsigned long nodes = 0;
+        error_code ec;
+        for (const auto &entry : filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+            string name = entry.path().filename();
+            if (name.starts_with("node") && name.size() > 4 && isdigit(name[4])) {
+                int node = stoi(name.substr(4));
+                if (node < 64) { nodes |= 1ul << node; }
+            }
+        }
+        return nodes ? nodes : 1ul;
+    }();
+    return mask;
+}
+
+void *mapBytes(size_t &bytes) {
+    static atomic<bool> hugetlbWarned{false}, mbindWarned{false};
+    void *p = MAP_FAILED;
+    if (AllocPolicy::hugePages == HugePages::Explicit) {
+        size_t rounded = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                 -1, 0);
+        if (p != MAP_FAILED) {
+            bytes = rounded;
+        } else {
+            warnOnce(hugetlbWarned, "no explicit huge pages available, using transparent ones");
+        }
+    }
+    if (p == MAP_FAILED) {
+        p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) { throw bad_alloc(); }
+        if (AllocPolicy::hugePages != HugePages::Off) { madvise(p, bytes, MADV_HUGEPAGE); }
+    }
+
+    if (AllocPolicy::placement == Placement::Interleave) {
+        unsigned long nodes = onlineNodes();
+        if (syscall(SYS_mbind, p, bytes, MPOL_INTERLEAVE, &nodes, 64, 0) != 0) {
+            warnOnce(mbindWarned, "mbind(MPOL_INTERLEAVE) failed, using default placement");
+        }
+    } else if (AllocPolicy::placement == Placement::FirstTouch) {
+        // fault the pages in with the same static split over threads as the parallel loops
+        char *bytesPtr = static_cast<char *>(p);
+        int64_t pages = (bytes + 4095) / 4096;
+#pragma omp parallel for schedule(static)
+        for (int64_t page = 0; page < pages; page++) { bytesPtr[page * 4096] = 0; }
+    }
+    return p;
+}
+
+} // namespace
+
+void *allocBytes(size_t bytes) {
+    bytes += sizeof(Header);
+    bool large = bytes >= AllocPolicy::minBytes && (AllocPolicy::placement != Placement::Default ||
+                                                    AllocPolicy::hugePages != HugePages::Off);
+    void *p = large ? mapBytes(bytes) : aligned_alloc(alignof(Header), (bytes + 63) / 64 * 64);
+    if (!p) { throw bad_alloc(); }
+    Header *header = new (p) Header{bytes, large};
+    return header + 1;
+}
+
+void freeArray(void *array) {
+    if (!array) { return; }
+    Header *header = static_cast<Header *>(array) - 1;
+    if (header->mapped) {
+        munmap(header, header->bytes);
+    } else {
+        free(header);
+    }
+}
+
+} // namespace gm
@@ -0,0 +1,41 @@
+#ifndef GM_ALLOC_HPP
+#define GM_ALLOC_HPP
+
+#include <cstddef>
+
+namespace gm {
+
+enum class Placement {
+    Default,    // pages go to the node of the thread that touches them first
+    Interleave, // pages spread round robin over all nodes
+    FirstTouch, // pages touched once by all threads in parallel, static schedule
+};
+
+enum class HugePages {
+    Off,
+    Transparent, // madvise(MADV_HUGEPAGE)
+    Explicit,    // MAP_HUGETLB 2 MiB pages, falls back to Transparent when none are reserved
+};
+
+/// How the graph arrays are placed in memory (--numa and --huge-pages). Arrays smaller than
+/// minBytes always come from the heap.
+struct AllocPolicy {
+    static inline Placement placement = Placement::Default;
+    static inline HugePages hugePages = HugePages::Off;
+    static inline size_t minBytes = size_t(1) << 21;
+};
+
+/// Uninitialised storage for the CSR arrays of a graph, following AllocPolicy. Release with
+/// freeArray. Falls back to a plain mapping (with a warning, once) if the policy can't be
+/// applied on this host.
+void *allocBytes(size_t bytes);
+void freeArray(void *array);
+
+template<class T>
+T *allocArray(size_t count) {
+    return static_cast<T *>(allocBytes(count * sizeof(T)));
+}
+
+} // namespace gm
+
+#endif // GM_ALLOC_HPP
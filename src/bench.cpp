@@ -0,0 +1,394 @@
+// Microbenchmarks for the loader, peeling and the ego network solvers.
+//
+// Every result is printed as one JSON object per line, e.g.
+//   {"bench":"degenOrdering","graph":"er","n":100000,"m":800000,"threads":1,"reps":5,
+//    "min_us":1234,"median_us":1250,"mean_us":1261}
+// so runs can be compared with a few lines of python.
+#include <getopt.h>
+#include <omp.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef GM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef GM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "graph/dynamic.hpp"
+#include "graph/generate.hpp"
+#include "graph/graphv2.hpp"
+#include "graph/kdefective.hpp"
+#include "graph/kplex.hpp"
+#include "graph/peel.hpp"
+#include "graph/pseudoclique.hpp"
+#include "graph/quasiclique.hpp"
+#include "graph/types.hpp"
+#include "heap.hpp"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static const char *USAGE = //
+    "Usage: bench [options]\n"
+    "    --help, -h     print help\n"
+    "    -n             number of vertices of each generated graph (default 100000)\n"
+    "    -r             repetitions per benchmark (default 5)\n"
+    "    -f             only run benchmarks whose name contains this string\n"
+    "    -o             write results to this file instead of stdout\n"
+    "    -k             k for k-plex and k-defective (default 3)\n"
+    "    --alpha        alpha for quasi-clique and pseudo-clique (default 0.8)\n"
+    "    --threads      comma separated thread counts for the drivers (default 1,max)\n"
+    "    --seed         seed for the generated graphs (default 1)\n";
+
+constexpr int LONGOPT_ALPHA = 10001;
+constexpr int LONGOPT_THREADS = 10002;
+constexpr int LONGOPT_SEED = 10003;
+static option longopts[] = {
+    {"help", no_argument, NULL, 'h'},
+    {"alpha", required_argument, NULL, LONGOPT_ALPHA},
+    {"threads", required_argument, NULL, LONGOPT_THREADS},
+    {"seed", required_argument, NULL, LONGOPT_SEED},
+    {0, 0, 0, 0}, // end of args
+};
+
+namespace {
+
+struct Options {
+    gm::v_int n = 100000;
+    int reps = 5;
+    string filter;
+    string outPath;
+    int k = 3;
+    double alpha = 0.8;
+    vector<int> threads;
+    uint64_t seed = 1;
+};
+
+struct GraphCase {
+    string name;
+    gm::v2::Graph graph;
+};
+
+void writeText(GraphCase &gc, const string &path) {
+    ofstream out{path};
+    out << gc.graph.size() << " " << gc.graph.nEdges() << "\n";
+    for (gm::v_id u = 0; u < gc.graph.size(); u++) {
+        for (gm::v_id v : gc.graph.iterNeighbours(u)) {
+            if (u < v) { out << u << " " << v << "\n"; }
+        }
+    }
+}
+
+// Copies of the text file as .gz / .zst, for the loaders built in. Returns their paths.
+vector<string> writeCompressed(const string &textPath) {
+    ifstream in{textPath, ios::binary};
+    string text{istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+    vector<string> paths;
+#ifdef GM_HAVE_ZLIB
+    gzFile gz = gzopen((textPath + ".gz").c_str(), "wb");
+    gzwrite(gz, text.data(), text.size());
+    gzclose(gz);
+    paths.push_back(textPath + ".gz");
+#endif
+#ifdef GM_HAVE_ZSTD
+    string compressed(ZSTD_compressBound(text.size()), '\0');
+    compressed.resize(ZSTD_compress(compressed.data(), compressed.size(), text.data(), text.size(),
+                                    ZSTD_CLEVEL_DEFAULT));
+    ofstream{textPath + ".zst", ios::binary} << compressed;
+    paths.push_back(textPath + ".zst");
+#endif
+    return paths;
+}
+
+// -- timing
+
+// Discards everything written to it
+class NullBuf : public streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+};
+
+class Runner {
+public:
+    Runner(const Options &opts, ostream &out) : opts(opts), out(out) {}
+
+    // Time body() opts.reps times after one warm-up run. setup() runs before every call
+    // and is not timed.
+    void run(const string &bench, GraphCase &gc, int threads, const function<void()> &body,
+             const function<void()> &setup = [] {}) {
+        if (!opts.filter.empty() && bench.find(opts.filter) == string::npos) { return; }
+        omp_set_num_threads(threads);
+        vector<double> times;
+        for (int rep = -1; rep < opts.reps; rep++) {
+            setup();
+            // keep the solvers' own logging out of the results
+            streambuf *coutBuf = cout.rdbuf(&nullBuf);
+            auto start = chrono::steady_clock::now();
+            body();
+            auto end = chrono::steady_clock::now();
+            cout.rdbuf(coutBuf);
+            if (rep >= 0) {
+                times.push_back(chrono::duration<double, micro>(end - start).count());
+            }
+        }
+        sort(times.begin(), times.end());
+        double mean = 0;
+        for (double t : times) { mean += t; }
+        mean /= times.size();
+        out << "{\"bench\":\"" << bench << "\",\"graph\":\"" << gc.name
+            << "\",\"n\":" << gc.graph.size() << ",\"m\":" << gc.graph.nEdges()
+            << ",\"threads\":" << threads
+            << ",\"reps\":" << times.size() << ",\"min_us\":" << int64_t(times.front())
+            << ",\"median_us\":" << int64_t(times[times.size() / 2])
+            << ",\"mean_us\":" << int64_t(mean) << "}" << endl;
+    }
+
+private:
+    const Options &opts;
+    ostream &out;
+    NullBuf nullBuf;
+};
+
+void benchGraph(Runner &runner, const Options &opts, GraphCase &gc, const fs::path &tmpDir) {
+    string textPath = tmpDir / (gc.name + ".txt");
+    string binaryPath = tmpDir / (gc.name + ".bin");
+    writeText(gc, textPath);
+    gm::v2::Graph base = gm::v2::Graph::readFromFile(textPath);
+    gm::v2::writeGraphBinary(base, binaryPath);
+
+    // -- loader
+    runner.run("readFromFile/text", gc, 1, [&] { gm::v2::Graph::readFromFile(textPath); });
+    runner.run("readFromFile/binary", gc, 1, [&] { gm::v2::Graph::readFromFile(binaryPath); });
+    for (const string &path : writeCompressed(textPath)) {
+        string bench = "readFromFile/" + fs::path(path).extension().string().substr(1);
+        runner.run(bench, gc, 1, [&] { gm::v2::Graph::readFromFile(path); });
+    }
+
+    // -- peeling
+    runner.run("degenOrdering", gc, 1, [&] { gm::v2::degenOrdering(base); });
+    runner.run("peelGraph", gc, 1, [&] { gm::peelGraph(base, opts.k, opts.alpha); });
+
+    vector<gm::v_id> degrees(base.size());
+    for (gm::v_id i = 0; i < base.size(); i++) { degrees[i] = base.degree(i); }
+    runner.run("LinearHeap/peel", gc, 1, [&] {
+        gm::GraphLinearHeap heap(base.size(), base.size() + 1, degrees);
+        for (gm::v_id i = 0; i < base.size(); i++) {
+            gm::v_id u = heap.popMin().first;
+            for (gm::v_id v : base.iterNeighbours(u)) { heap.decrement(v, 1); }
+        }
+    });
+    gm::GraphBucketHeap bucketHeap;
+    runner.run("BucketHeap/peel", gc, 1, [&] {
+        bucketHeap.reset(degrees);
+        for (gm::v_id i = 0; i < base.size(); i++) {
+            gm::v_id u = bucketHeap.popMin().first;
+            bucketHeap.decrementBatch(base.edges(u), base.edgesEnd(u));
+        }
+    });
+
+    // -- ego networks: one-hop, forward in the degeneracy ordering, as the drivers build them
+    gm::PeelResult peel = gm::peelGraph(base, opts.k, opts.alpha);
+    runner.run("rankGraph", gc, 1, [&] { gm::rankGraph(base, peel.ordering); });
+    gm::v2::Graph ranked = std::move(gm::rankGraph(base, peel.ordering).graph);
+    vector<vector<gm::v_id>> egos;
+    for (gm::v_id u = 0; u < ranked.size(); u++) {
+        vector<gm::v_id> vertices{u};
+        for (gm::v_id v : ranked.iterNeighbours(u)) {
+            if (v > u) { break; }
+            vertices.push_back(v);
+        }
+        if (vertices.size() > 2) { egos.push_back(std::move(vertices)); }
+    }
+    runner.run("subgraphDegen", gc, 1, [&] {
+        for (auto &vertices : egos) { gm::v2::subgraphDegen(ranked, vertices); }
+    });
+
+    // -- inner kernels on the largest ego networks
+    sort(egos.begin(), egos.end(), [](const auto &a, const auto &b) { return a.size() > b.size(); });
+    egos.resize(min<size_t>(egos.size(), 1000));
+    // both ways of building subgraphDegen, on the ego networks where they differ most
+    gm::v_int minSize = gm::v2::INTERSECT_MIN_SIZE;
+    gm::v2::INTERSECT_MIN_SIZE = numeric_limits<gm::v_int>::max();
+    runner.run("subgraphDegen/largest/probe", gc, 1, [&] {
+        for (auto &vertices : egos) { gm::v2::subgraphDegen(ranked, vertices); }
+    });
+    gm::v2::INTERSECT_MIN_SIZE = 0;
+    runner.run("subgraphDegen/largest/intersect", gc, 1, [&] {
+        for (auto &vertices : egos) { gm::v2::subgraphDegen(ranked, vertices); }
+    });
+    gm::v2::INTERSECT_MIN_SIZE = minSize;
+    vector<gm::v2::Graph> subgraphs;
+    subgraphs.reserve(egos.size());
+    for (auto &vertices : egos) {
+        subgraphs.push_back(gm::v2::subgraphDegen(ranked, vertices));
+    }
+    runner.run("kernel/kPlexDegen", gc, 1, [&] {
+        for (auto &sub : subgraphs) { gm::kPlexDegen(sub, opts.k); }
+    });
+    runner.run("kernel/kDefNaiveV2", gc, 1, [&] {
+        for (auto &sub : subgraphs) { gm::kDefNaiveV2(sub, opts.k); }
+    });
+    runner.run("kernel/quasiCliqueNaive", gc, 1, [&] {
+        for (auto &sub : subgraphs) { gm::quasiCliqueNaive(sub, opts.alpha); }
+    });
+    runner.run("kernel/pseudoCliqueNaive", gc, 1, [&] {
+        for (auto &sub : subgraphs) { gm::pseudoCliqueNaive(sub, opts.alpha); }
+    });
+    // the same kernels with 16-bit ids, as the ego loop runs them
+    vector<gm::v2::SmallGraph> smallSubgraphs;
+    for (auto &vertices : egos) {
+        if (gm::v_int(vertices.size()) > gm::v2::SMALL_GRAPH_MAX) { continue; }
+        smallSubgraphs.push_back(gm::v2::subgraphDegen<gm::v2::SmallGraph>(ranked, vertices));
+    }
+    runner.run("kernel/kPlexDegen/16", gc, 1, [&] {
+        for (auto &sub : smallSubgraphs) { gm::kPlexDegen(sub, opts.k); }
+    });
+    runner.run("kernel/kDefNaiveV2/16", gc, 1, [&] {
+        for (auto &sub : smallSubgraphs) { gm::kDefNaiveV2(sub, opts.k); }
+    });
+    runner.run("kernel/quasiCliqueNaive/16", gc, 1, [&] {
+        for (auto &sub : smallSubgraphs) { gm::quasiCliqueNaive(sub, opts.alpha); }
+    });
+    runner.run("kernel/pseudoCliqueNaive/16", gc, 1, [&] {
+        for (auto &sub : smallSubgraphs) { gm::pseudoCliqueNaive(sub, opts.alpha); }
+    });
+
+    // -- drivers
+    for (int threads : opts.threads) {
+        runner.run("driver/kPlexV2", gc, threads, [&] { gm::kPlexV2(base, opts.k, false); });
+        runner.run("driver/kPlexV2/twohop", gc, threads, [&] { gm::kPlexV2(base, opts.k, true); });
+        runner.run("driver/kDefDegenV2", gc, threads, [&] { gm::kDefDegenV2(base, opts.k); });
+        runner.run("driver/quasiClique", gc, threads, [&] { gm::quasiClique(base, opts.alpha); });
+        runner.run("driver/pseudoClique", gc, threads, [&] { gm::pseudoClique(base, opts.alpha); });
+    }
+
+    // -- dynamic graphs: batches of random deletions and insertions
+    vector<vector<gm::EdgeUpdate>> batches(8);
+    mt19937_64 rng{opts.seed};
+    uniform_int_distribution<gm::v_id> vertex(0, base.size() - 1);
+    for (auto &batch : batches) {
+        for (int i = 0; i < 256; i++) {
+            gm::v_id u = vertex(rng);
+            if (i % 2 == 0 && base.degree(u) > 0) {
+                batch.push_back({false, u, base.edges(u)[rng() % base.degree(u)]});
+            } else {
+                batch.push_back({true, u, vertex(rng)});
+            }
+        }
+    }
+    auto applyBatch = [](gm::DynamicGraph &dynamic, const vector<gm::EdgeUpdate> &batch,
+                         bool rebuild) {
+        vector<gm::EdgeUpdate> updates = gm::lastUpdates(batch);
+        if (rebuild) {
+            dynamic.rebuild(updates);
+        } else {
+            for (auto [insert, u, v] : updates) {
+                insert ? dynamic.insert(u, v) : dynamic.erase(u, v);
+            }
+        }
+    };
+    // the core numbers kept up to date have to match a fresh peel after every batch
+    for (bool rebuild : {false, true}) {
+        gm::DynamicGraph dynamic{base, peel.coreNumber};
+        for (const auto &batch : batches) {
+            applyBatch(dynamic, batch, rebuild);
+            gm::v2::Graph g = dynamic.toGraph();
+            GM_ASSERT(dynamic.coreNumbers() == gm::peelGraph(g, opts.k, opts.alpha).coreNumber,
+                      "bench: DynamicGraph core numbers differ from peelGraph");
+        }
+    }
+    optional<gm::DynamicGraph> dynamic;
+    for (bool rebuild : {false, true}) {
+        runner.run(rebuild ? "DynamicGraph/rebuild" : "DynamicGraph/updates", gc, 1, [&] {
+            for (const auto &batch : batches) { applyBatch(*dynamic, batch, rebuild); }
+        }, [&] { dynamic.emplace(base, peel.coreNumber); });
+    }
+}
+
+vector<int> parseThreads(const char *arg) {
+    vector<int> threads;
+    stringstream ss{arg};
+    string item;
+    while (getline(ss, item, ',')) { threads.push_back(stoi(item)); }
+    return threads;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opts;
+    int ch;
+    while ((ch = getopt_long(argc, argv, "n:r:f:o:k:h", longopts, NULL)) != -1) {
+        switch (ch) {
+        case 'n':
+            opts.n = strtol(optarg, NULL, 10);
+            break;
+        case 'r':
+            opts.reps = strtol(optarg, NULL, 10);
+            break;
+        case 'f':
+            opts.filter = optarg;
+            break;
+        case 'o':
+            opts.outPath = optarg;
+            break;
+        case 'k':
+            opts.k = strtol(optarg, NULL, 10);
+            break;
+        case LONGOPT_ALPHA:
+            opts.alpha = strtod(optarg, NULL);
+            break;
+        case LONGOPT_THREADS:
+            opts.threads = parseThreads(optarg);
+            break;
+        case LONGOPT_SEED:
+            opts.seed = strtoull(optarg, NULL, 10);
+            break;
+        default:
+            cout << USAGE;
+            return 0;
+        }
+    }
+    if (opts.threads.empty()) {
+        opts.threads = {1};
+        if (omp_get_max_threads() > 1) { opts.threads.push_back(omp_get_max_threads()); }
+    }
+
+    ofstream outFile;
+    if (!opts.outPath.empty()) { outFile.open(opts.outPath); }
+    ostream out{opts.outPath.empty() ? cout.rdbuf() : outFile.rdbuf()};
+    Runner runner{opts, out};
+
+    fs::path tmpDir = fs::temp_directory_path() / ("gm-bench-" + to_string(getpid()));
+    fs::create_directories(tmpDir);
+
+    // uniform, two heavy-tailed shapes, and one with a dense set for the solvers to find
+    for (string model : {"er", "rmat", "ba", "kplex"}) {
+        gm::GenerateOptions generate{.model = model, .n = opts.n, .m = int64_t(opts.n) * 8,
+                                     .seed = opts.seed, .k = opts.k, .plantedSize = 40};
+        GraphCase gc{model, gm::generateGraph(generate).graph};
+        benchGraph(runner, opts, gc, tmpDir);
+    }
+
+    fs::remove_all(tmpDir);
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "graph/allmodels.hpp"
+
+#include <format>
+#include <iostream>
+#include <utility>
+
+#include "graph/egoloop.hpp"
+#include "graph/graphv2.hpp"
+#include "graph/kdefective.hpp"
+#include "graph/kplex.hpp"
+#include "graph/peel.hpp"
+#include "graph/pseudoclique.hpp"
+#include "graph/quasiclique.hpp"
+#include "graph/types.hpp"
+#include "stats.hpp"
+
+namespace gm {
+
+using namespace std;
+
+AllModelsResult allModels(v2::Graph &g, v_int k, double alpha, bool twoHop) {
+    PeelResult peel = peelGraph(g, k, alpha);
+    cout << format("Initial solution sizes: kplex={} kdef={} quasi={} pseudo={}\n",
+                   peel.kPlex.kPlex.size(), peel.kDef.size, peel.quasiClique.size,
+                   peel.pseudoClique.size);
+    stats().set("initial_size_kplex", peel.kPlex.kPlex.size());
+    stats().set("initial_size_kdef", peel.kDef.size);
+    stats().set("initial_size_quasi", peel.quasiClique.size);
+    stats().set("initial_size_pseudo", peel.pseudoClique.size);
+
+    RankedGraph ranked = rankGraph(g, peel.ordering);
+    releaseGraph(g);
+    using Models = EgoModels<KPlexModel, KDefModel, QuasiCliqueModel, PseudoCliqueModel>;
+    Models models{{KPlexModel{.k = k}, KDefModel{.k = k}, QuasiCliqueModel{.alpha = alpha},
+                   PseudoCliqueModel{.alpha = alpha}}};
+    Models::Solutions solutions =
+        egoLoop(ranked, models, twoHop,
+                {std::move(peel.kPlex.kPlex), std::move(peel.kDef.kDefective),
+                 std::move(peel.quasiClique.subgraph), std::move(peel.pseudoClique.subgraph)});
+    g = unrankGraph(ranked);
+    return {.kPlex = {.kPlex = std::move(solutions[0]), .ub = peel.kPlex.ub},
+            .kDef = {.kDefective = std::move(solutions[1])},
+            .quasiClique = {.subgraph = std::move(solutions[2])},
+            .pseudoClique = {.subgraph = std::move(solutions[3])}};
+}
+
+} // namespace gm
@@ -0,0 +1,27 @@
+#ifndef GM_ALLMODELS_HPP
+#define GM_ALLMODELS_HPP
+
+#include "graph/graphv2.hpp"
+#include "graph/kdefective.hpp"
+#include "graph/kplex.hpp"
+#include "graph/types.hpp"
+
+namespace gm {
+
+struct AllModelsResult {
+    KPlexDegenResult kPlex;
+    kDefResult kDef;
+    SubgraphResult quasiClique;
+    SubgraphResult pseudoClique;
+};
+
+/// kPlexV2, kDefDegenV2, quasiClique and pseudoClique in one pass: one peel for the ordering
+/// and the four initial solutions, one ranked graph and one egoLoop, which builds each ego
+/// network once for the four kernels. It is collected with the weakest filters of the models
+/// that keep its root, and each kernel runs on the vertices its own filters keep. Pseudo-cliques
+/// need every edge, so there is no truss pruning.
+AllModelsResult allModels(v2::Graph &g, v_int k, double alpha, bool twoHop);
+
+} // namespace gm
+
+#endif // GM_ALLMODELS_HPP
@@ -0,0 +1,81 @@
+#include "graph/bounds.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/types.hpp"
+
+namespace gm {
+
+using namespace std;
+
+namespace {
+
+thread_local vector<v_int> degrees, order, buckets, color, used, classes;
+
+// vertices by degree, largest first (counting sort)
+template<class G>
+void sortByDegree(G &g) {
+    v_int size = g.size(), maxDegree = 0;
+    for (v_int u = 0; u < size; u++) { maxDegree = max(maxDegree, g.degree(u)); }
+    buckets.assign(maxDegree + 2, 0);
+    for (v_int u = 0; u < size; u++) { buckets[maxDegree - g.degree(u) + 1]++; }
+    for (v_int d = 1; d <= maxDegree + 1; d++) { buckets[d] += buckets[d - 1]; }
+    order.resize(size);
+    for (v_int u = 0; u < size; u++) { order[buckets[maxDegree - g.degree(u)]++] = u; }
+}
+
+} // namespace
+
+template<class G>
+const vector<v_int> &degreesDescending(G &g) {
+    sortByDegree(g);
+    degrees.resize(g.size());
+    for (v_int i = 0; i < g.size(); i++) { degrees[i] = g.degree(order[i]); }
+    return degrees;
+}
+
+template<class G>
+const vector<v_int> &colorClasses(G &g) {
+    v_int size = g.size();
+    sortByDegree(g);
+    color.assign(size, -1);
+    // used[c] == u marks color c as taken by a neighbour of u
+    used.assign(size + 1, -1);
+    classes.clear();
+    for (v_int u : order) {
+        for (v_int v : g.iterNeighbours(u)) {
+            if (color[v] >= 0) { used[color[v]] = u; }
+        }
+        v_int c = 0;
+        while (used[c] == u) { c++; }
+        color[u] = c;
+        if (c == v_int(classes.size())) { classes.push_back(0); }
+        classes[c]++;
+    }
+    sort(classes.begin(), classes.end(), greater<v_int>());
+    return classes;
+}
+
+template const vector<v_int> &degreesDescending(v2::Graph &g);
+template const vector<v_int> &degreesDescending(v2::SmallGraph &g);
+template const vector<v_int> &colorClasses(v2::Graph &g);
+template const vector<v_int> &colorClasses(v2::SmallGraph &g);
+
+v_int coloringBound(const vector<v_int> &classes, v_int missingEdges) {
+    // the t-th extra vertex of a class misses t edges inside it, so take extras level by level
+    v_int bound = classes.size();
+    for (v_int t = 1; missingEdges >= t; t++) {
+        v_int available = 0;
+        while (available < v_int(classes.size()) && classes[available] > t) { available++; }
+        if (available == 0) { break; }
+        v_int take = min(available, missingEdges / t);
+        bound += take;
+        missingEdges -= take * t;
+        if (take < available) { break; }
+    }
+    return bound;
+}
+
+} // namespace gm
@@ -0,0 +1,41 @@
+#ifndef GM_BOUNDS_HPP
+#define GM_BOUNDS_HPP
+
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/types.hpp"
+
+namespace gm {
+
+/// Cheap upper bounds on the size of a solution inside an ego network, so the ego loop can
+/// skip networks that can't beat the incumbent without running the kernel on them.
+
+/// Degrees of g, largest first. The vector is reused by the calling thread.
+template<class G>
+const std::vector<v_int> &degreesDescending(G &g);
+
+/// Sizes of the color classes of a greedy coloring of g, visiting vertices largest degree
+/// first. Each class is an independent set. The vector is reused by the calling thread.
+template<class G>
+const std::vector<v_int> &colorClasses(G &g);
+
+/// Largest s such that at least s vertices have degree >= minDegree(s), for degrees sorted
+/// largest first
+template<class F>
+v_int degreeBound(const std::vector<v_int> &degrees, F minDegree) {
+    v_int bound = 0;
+    for (v_int s = 1; s <= v_int(degrees.size()); s++) {
+        if (degrees[s - 1] >= minDegree(s)) { bound = s; }
+    }
+    return bound;
+}
+
+/// Most vertices that can be taken from the color classes with at most missingEdges pairs
+/// in the same class: a clique takes one per class, a k-defective clique spends its budget
+/// on the cheapest extra vertices
+v_int coloringBound(const std::vector<v_int> &classes, v_int missingEdges);
+
+} // namespace gm
+
+#endif // GM_BOUNDS_HPP
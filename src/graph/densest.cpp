@@ -0,0 +1,152 @@
+#include "graph/densest.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/types.hpp"
+#include "perf.hpp"
+#include "scratch.hpp"
+#include "stats.hpp"
+
+namespace gm {
+
+using namespace std;
+
+namespace {
+
+enum VertexState : uint8_t { Alive, Batch, Peeled };
+
+} // namespace
+
+DensestResult densestSubgraph(v2::Graph &g, int iterations, double epsilon, double gap) {
+    PhaseTimer timer{Phase::Peel};
+    PerfScope perfScope{PerfPhase::Peel};
+    v_int n = g.size();
+    DensestResult result;
+    if (n == 0) { return result; }
+
+    vector<int64_t> load(n, 0);
+    vector<v_int> degree(n);
+    vector<uint8_t> state(n);
+    // vertices not peeled yet, the batch peeled next and the peeling order of this pass
+    vector<v_id> remaining, rest, batch, order;
+    remaining.reserve(n);
+    rest.reserve(n);
+    order.reserve(n);
+    int64_t perVertex = sizeof(int64_t) + 2 * sizeof(v_int) + sizeof(uint8_t) + 3 * sizeof(v_id);
+    TrackedBytes bytes{Memory::Peel, n * perVertex};
+
+    result.upperBound = numeric_limits<double>::infinity();
+    for (int iteration = 1; iteration <= iterations; iteration++) {
+#pragma omp parallel for schedule(static)
+        for (v_int v = 0; v < n; v++) {
+            degree[v] = g.degree(v);
+            state[v] = Alive;
+        }
+        remaining.resize(n);
+        std::iota(remaining.begin(), remaining.end(), 0);
+        order.clear();
+        int64_t edges = g.eSize() / 2;
+        // the densest suffix of this pass is order[bestStart..], -1 if it beat no earlier pass
+        int64_t bestStart = -1;
+
+        while (!remaining.empty()) {
+            double density = double(edges) / remaining.size();
+            if (density > result.density) {
+                result.density = density;
+                bestStart = order.size();
+            }
+
+            int64_t keys = 0;
+#pragma omp parallel for schedule(static) reduction(+ : keys)
+            for (size_t i = 0; i < remaining.size(); i++) {
+                keys += load[remaining[i]] + degree[remaining[i]];
+            }
+            // the vertex of smallest key is never above the average, so the batch isn't empty
+            double threshold = (1. + epsilon) * double(keys) / remaining.size();
+            batch.clear();
+            rest.clear();
+#pragma omp parallel
+            {
+                vector<v_id> localBatch, localRest;
+#pragma omp for schedule(static) nowait
+                for (size_t i = 0; i < remaining.size(); i++) {
+                    v_id v = remaining[i];
+                    (load[v] + degree[v] <= threshold ? localBatch : localRest).push_back(v);
+                }
+#pragma omp critical(gm_densest_batch)
+                {
+                    batch.insert(batch.end(), localBatch.begin(), localBatch.end());
+                    rest.insert(rest.end(), localRest.begin(), localRest.end());
+                }
+            }
+            for (v_id v : batch) { state[v] = Batch; }
+
+            int64_t removed = 0;
+#pragma omp parallel for schedule(dynamic, 64) reduction(+ : removed)
+            for (size_t i = 0; i < batch.size(); i++) {
+                v_id v = batch[i];
+                int64_t charged = 0;
+                for (v_id w : g.iterNeighbours(v)) {
+                    if (state[w] == Alive) {
+                        charged++;
+#pragma omp atomic
+                        degree[w]--;
+                    } else if (state[w] == Batch && w > v) {
+                        charged++;
+                    }
+                }
+                load[v] += charged;
+                removed += charged;
+            }
+            for (v_id v : batch) { state[v] = Peeled; }
+            order.insert(order.end(), batch.begin(), batch.end());
+            edges -= removed;
+            swap(remaining, rest);
+        }
+
+        if (bestStart >= 0) {
+            result.subgraph.assign(order.begin() + bestStart, order.end());
+            std::sort(result.subgraph.begin(), result.subgraph.end());
+        }
+        int64_t maxLoad = 0;
+#pragma omp parallel for schedule(static) reduction(max : maxLoad)
+        for (v_int v = 0; v < n; v++) { maxLoad = std::max(maxLoad, load[v]); }
+        result.upperBound = std::min(result.upperBound, double(maxLoad) / iteration);
+        result.iterations = iteration;
+
+        double currentGap = result.density > 0 ? result.upperBound / result.density - 1 : 0.;
+        cout << format("[densest] iteration {}: density={:.6f} upper bound={:.6f} gap={:.6f}\n",
+                       iteration, result.density, result.upperBound, currentGap);
+        if (currentGap <= gap) { break; }
+    }
+    stats().set("densest_iterations", result.iterations);
+    stats().set("densest_density", result.density);
+    stats().set("densest_upper_bound", result.upperBound);
+    return result;
+}
+
+bool validateDensest(v2::Graph &g, const std::vector<v_id> &subgraph, double density) {
+    PhaseTimer timer{Phase::Validate};
+    PerfScope perfScope{PerfPhase::Validate};
+    if (subgraph.empty()) { return density <= 0; }
+    std::vector<v_int> &sorted = sortedSolution(subgraph);
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) { return false; }
+
+    int64_t nEdges = 0;
+    for (auto u : subgraph) {
+        for (v_id w : g.iterNeighbours(u)) {
+            nEdges += std::binary_search(sorted.begin(), sorted.end(), w);
+        }
+    }
+    // allow for rounding in the density
+    return double(nEdges) / 2 / subgraph.size() >= density * (1 - 1e-9);
+}
+
+} // namespace gm
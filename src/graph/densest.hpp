@@ -0,0 +1,31 @@
+#ifndef GM_DENSEST_HPP
+#define GM_DENSEST_HPP
+
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/types.hpp"
+
+namespace gm {
+
+struct DensestResult {
+    std::vector<v_id> subgraph;
+    double density = 0.;    // edges / vertices of subgraph
+    double upperBound = 0.; // no subgraph of the graph is denser than this
+    int iterations = 0;
+};
+
+/// Greedy++: peel the whole graph `iterations` times, each time by the load a vertex collected
+/// in the earlier passes plus its current degree, and keep the densest suffix seen. A pass
+/// peels every vertex whose key is at most (1 + epsilon) times the average at once, in parallel;
+/// edges inside a batch are charged to the endpoint with the smaller id. The loads divided by
+/// the number of passes are a fractional orientation, so the largest one bounds the density of
+/// any subgraph. Stops early once upperBound / density - 1 <= gap.
+DensestResult densestSubgraph(v2::Graph &g, int iterations, double epsilon, double gap);
+
+/// True if the vertices are distinct and induce at least density * size edges
+bool validateDensest(v2::Graph &g, const std::vector<v_id> &subgraph, double density);
+
+} // namespace gm
+
+#endif // GM_DENSEST_HPP
@@ -0,0 +1,331 @@
+#include "graph/dynamic.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/types.hpp"
+#include "stats.hpp"
+#include "util.hpp"
+
+namespace gm {
+
+using namespace std;
+
+namespace {
+
+// the same key for u-v and v-u
+uint64_t edgeKey(v_int u, v_int v) {
+    return uint64_t(uint32_t(min(u, v))) << 32 | uint32_t(max(u, v));
+}
+
+} // namespace
+
+vector<vector<EdgeUpdate>> readUpdates(const string &path) {
+    ifstream in{path};
+    GM_ASSERT(in, "readUpdates: cannot open " + path);
+    vector<vector<EdgeUpdate>> batches(1);
+    string line;
+    while (getline(in, line)) {
+        istringstream fields{line};
+        char op;
+        EdgeUpdate update;
+        if (!(fields >> op)) {
+            if (!batches.back().empty()) { batches.emplace_back(); }
+            continue;
+        }
+        GM_ASSERT((op == '+' || op == '-') && (fields >> update.u >> update.v),
+                  "readUpdates: expected \"+ u v\" or \"- u v\", got \"" + line + "\"");
+        update.insert = op == '+';
+        batches.back().push_back(update);
+    }
+    if (batches.back().empty()) { batches.pop_back(); }
+    return batches;
+}
+
+vector<EdgeUpdate> lastUpdates(const vector<EdgeUpdate> &batch) {
+    unordered_map<uint64_t, size_t> last;
+    last.reserve(batch.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+        if (batch[i].u != batch[i].v) { last[edgeKey(batch[i].u, batch[i].v)] = i; }
+    }
+    vector<EdgeUpdate> result;
+    result.reserve(last.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+        if (batch[i].u != batch[i].v && last[edgeKey(batch[i].u, batch[i].v)] == i) {
+            result.push_back(batch[i]);
+        }
+    }
+    return result;
+}
+
+TemporalEdges readTemporalEdges(const string &path) {
+    PhaseTimer timer{Phase::Load};
+    ifstream in{path};
+    GM_ASSERT(in, "readTemporalEdges: cannot open " + path);
+    TemporalEdges stream;
+    string line;
+    while (getline(in, line)) {
+        istringstream fields{line};
+        TemporalEdge edge;
+        if (line.empty() || line[0] == '#' || !(fields >> edge.u >> edge.v >> edge.t)) {
+            GM_ASSERT(line.find_first_not_of(" \t\r") == string::npos || line[0] == '#',
+                      "readTemporalEdges: expected \"u v t\", got \"" + line + "\"");
+            continue;
+        }
+        GM_ASSERT(edge.u >= 0 && edge.v >= 0, "readTemporalEdges: negative vertex id");
+        stream.n = max(stream.n, max(edge.u, edge.v) + 1);
+        stream.edges.push_back(edge);
+    }
+    stable_sort(stream.edges.begin(), stream.edges.end(),
+                [](const TemporalEdge &a, const TemporalEdge &b) { return a.t < b.t; });
+    return stream;
+}
+
+SlidingWindow::SlidingWindow(const TemporalEdges &stream, int64_t window, int64_t slide)
+    : stream(stream), window(window), slide(slide),
+      begin(stream.edges.empty() ? 0 : stream.edges.front().t) {
+    GM_ASSERT(window > 0 && slide > 0, "SlidingWindow: window and slide have to be positive");
+}
+
+bool SlidingWindow::next(vector<EdgeUpdate> &batch) {
+    batch.clear();
+    if (!first) { begin += slide; }
+    first = false;
+    if (arrived == stream.edges.size() && (stream.edges.empty() || begin > stream.edges.back().t)) {
+        return false;
+    }
+
+    // count occurrences entering and leaving, then emit only edges whose presence changed
+    before.clear();
+    auto change = [&](const TemporalEdge &edge, int32_t delta) {
+        if (edge.u == edge.v) { return; }
+        uint64_t k = edgeKey(edge.u, edge.v);
+        int32_t &count = multiplicity[k];
+        before.try_emplace(k, count);
+        count += delta;
+    };
+    for (; arrived < stream.edges.size() && stream.edges[arrived].t < end(); arrived++) {
+        change(stream.edges[arrived], 1);
+    }
+    for (; expired < arrived && stream.edges[expired].t < start(); expired++) {
+        change(stream.edges[expired], -1);
+    }
+    for (auto [k, was] : before) {
+        int32_t now = multiplicity[k];
+        if ((was > 0) != (now > 0)) { batch.push_back({now > 0, v_int(k >> 32), v_int(k)}); }
+        if (now == 0) { multiplicity.erase(k); }
+    }
+    sort(batch.begin(), batch.end(), [](const EdgeUpdate &a, const EdgeUpdate &b) {
+        return make_pair(a.u, a.v) < make_pair(b.u, b.v);
+    });
+    return true;
+}
+
+DynamicGraph::DynamicGraph(v2::Graph &g, vector<v_int> coreNumber)
+    : adj(g.size()), core(std::move(coreNumber)), isChanged(g.size(), 0), count(g.size(), 0),
+      mark(g.size(), 0) {
+    for (v_int u = 0; u < g.size(); u++) { adj[u].assign(g.edges(u), g.edgesEnd(u)); }
+    m = g.nEdges();
+}
+
+bool DynamicGraph::adjacent(v_int u, v_int v) const {
+    return binary_search(adj[u].begin(), adj[u].end(), v);
+}
+
+namespace {
+
+// marks of the traversals
+enum : uint8_t { Unseen, Candidate, Rejected, Dropped };
+
+} // namespace
+
+v_int DynamicGraph::countAtLeast(v_int u, v_int r) const {
+    v_int n = 0;
+    for (v_int x : adj[u]) { n += core[x] >= r; }
+    return n;
+}
+
+void DynamicGraph::changeCore(v_int u, v_int newCore) {
+    core[u] = newCore;
+    if (!isChanged[u]) {
+        isChanged[u] = 1;
+        changed.push_back(u);
+    }
+}
+
+bool DynamicGraph::insert(v_int u, v_int v) {
+    if (u == v || adjacent(u, v)) { return false; }
+    adj[u].insert(lower_bound(adj[u].begin(), adj[u].end(), v), v);
+    adj[v].insert(lower_bound(adj[v].begin(), adj[v].end(), u), u);
+    m++;
+
+    // vertices that can reach r + 1 have more than r neighbours of core >= r, and are
+    // connected to u or v through such vertices
+    v_int r = min(core[u], core[v]);
+    visited.clear();
+    auto visit = [&](v_int w) {
+        if (core[w] != r || mark[w] != Unseen) { return; }
+        mark[w] = countAtLeast(w, r) > r ? Candidate : Rejected;
+        visited.push_back(w);
+    };
+    visit(u);
+    visit(v);
+    for (size_t i = 0; i < visited.size(); i++) {
+        if (mark[visited[i]] != Candidate) { continue; }
+        for (v_int x : adj[visited[i]]) { visit(x); }
+    }
+
+    // drop candidates left with r or fewer neighbours of core > r or among the candidates
+    evict.clear();
+    for (v_int w : visited) {
+        if (mark[w] != Candidate) { continue; }
+        count[w] = 0;
+        for (v_int x : adj[w]) { count[w] += core[x] > r || mark[x] == Candidate; }
+    }
+    for (v_int w : visited) {
+        if (mark[w] == Candidate && count[w] <= r) {
+            mark[w] = Dropped;
+            evict.push_back(w);
+        }
+    }
+    while (!evict.empty()) {
+        v_int w = evict.back();
+        evict.pop_back();
+        for (v_int x : adj[w]) {
+            if (mark[x] == Candidate && --count[x] <= r) {
+                mark[x] = Dropped;
+                evict.push_back(x);
+            }
+        }
+    }
+    for (v_int w : visited) {
+        if (mark[w] == Candidate) { changeCore(w, r + 1); }
+        mark[w] = Unseen;
+    }
+    return true;
+}
+
+bool DynamicGraph::erase(v_int u, v_int v) {
+    if (u == v || !adjacent(u, v)) { return false; }
+    adj[u].erase(lower_bound(adj[u].begin(), adj[u].end(), v));
+    adj[v].erase(lower_bound(adj[v].begin(), adj[v].end(), u));
+    m--;
+
+    // a vertex of core r drops once fewer than r neighbours of core >= r stay; only u, v and
+    // neighbours of vertices that dropped can. Counts are taken when a vertex is first seen
+    // and lowered as each dropped neighbour is popped.
+    v_int r = min(core[u], core[v]);
+    visited.clear();
+    evict.clear();
+    auto check = [&](v_int w, bool lostNeighbour) {
+        if (core[w] != r || mark[w] == Dropped) { return; }
+        if (mark[w] == Unseen) {
+            count[w] = countAtLeast(w, r);
+            mark[w] = Candidate;
+            visited.push_back(w);
+        }
+        if (lostNeighbour) { count[w]--; }
+        if (count[w] < r) {
+            mark[w] = Dropped;
+            evict.push_back(w);
+        }
+    };
+    check(u, false);
+    check(v, false);
+    while (!evict.empty()) {
+        v_int w = evict.back();
+        evict.pop_back();
+        for (v_int x : adj[w]) { check(x, true); }
+    }
+    for (v_int w : visited) {
+        if (mark[w] == Dropped) { changeCore(w, r - 1); }
+        mark[w] = Unseen;
+    }
+    return true;
+}
+
+void DynamicGraph::rebuild(const vector<EdgeUpdate> &batch) {
+    // deletions while the lists are still sorted, then insertions appended and sorted once
+    visited.clear();
+    for (bool inserting : {false, true}) {
+        for (auto [insert, u, v] : batch) {
+            if (insert != inserting || u == v) { continue; }
+            for (auto [a, b] : {pair{u, v}, pair{v, u}}) {
+                if (insert) {
+                    adj[a].push_back(b);
+                    if (mark[a] == Unseen) {
+                        mark[a] = Candidate;
+                        visited.push_back(a);
+                    }
+                } else {
+                    auto it = lower_bound(adj[a].begin(), adj[a].end(), b);
+                    if (it != adj[a].end() && *it == b) { adj[a].erase(it); }
+                }
+            }
+        }
+    }
+    for (v_int u : visited) {
+        sort(adj[u].begin(), adj[u].end());
+        adj[u].erase(unique(adj[u].begin(), adj[u].end()), adj[u].end());
+        mark[u] = Unseen;
+    }
+    m = 0;
+    for (const auto &list : adj) { m += list.size(); }
+    m /= 2;
+
+    // bucket peel by current degree, with count as the degree
+    v_int n = size(), maxDegree = 0;
+    for (v_int u = 0; u < n; u++) {
+        count[u] = adj[u].size();
+        maxDegree = max(maxDegree, count[u]);
+    }
+    vector<v_int> start(maxDegree + 2, 0), order(n), position(n);
+    for (v_int u = 0; u < n; u++) { start[count[u] + 1]++; }
+    for (v_int d = 0; d <= maxDegree; d++) { start[d + 1] += start[d]; }
+    for (v_int u = 0; u < n; u++) {
+        position[u] = start[count[u]]++;
+        order[position[u]] = u;
+    }
+    for (v_int d = maxDegree; d > 0; d--) { start[d] = start[d - 1]; }
+    start[0] = 0;
+    for (v_int i = 0; i < n; i++) {
+        v_int u = order[i];
+        if (count[u] != core[u]) { changeCore(u, count[u]); }
+        for (v_int x : adj[u]) {
+            if (count[x] <= count[u]) { continue; }
+            // swap x to the front of its bucket, then move the bucket boundary past it
+            v_int d = count[x], front = order[start[d]];
+            if (front != x) {
+                swap(order[position[x]], order[start[d]]);
+                swap(position[front], position[x]);
+            }
+            start[d]++;
+            count[x]--;
+        }
+    }
+}
+
+vector<v_int> DynamicGraph::takeCoreChanges() {
+    for (v_int u : changed) { isChanged[u] = 0; }
+    return std::exchange(changed, {});
+}
+
+v2::Graph DynamicGraph::toGraph() const {
+    int64_t slots = 0;
+    for (const auto &list : adj) { slots += list.size(); }
+    v2::Graph g{size(), v_int(slots / 2)};
+    g.off[0] = 0;
+    for (v_int u = 0; u < size(); u++) {
+        g.off[u + 1] = g.off[u] + adj[u].size();
+        copy(adj[u].begin(), adj[u].end(), g.e + g.off[u]);
+    }
+    return g;
+}
+
+} // namespace gm
@@ -0,0 +1,419 @@
+#ifndef GM_DYNAMIC_HPP
+#define GM_DYNAMIC_HPP
+
+#include <omp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/types.hpp"
+#include "scratch.hpp"
+#include "stats.hpp"
+#include "util.hpp"
+
+namespace gm {
+
+/// One line of an --updates file
+struct EdgeUpdate {
+    bool insert;
+    v_int u, v;
+};
+
+/// Batches of "+ u v" (insert) and "- u v" (delete) lines, separated by blank lines
+std::vector<std::vector<EdgeUpdate>> readUpdates(const std::string &path);
+
+/// The last update of each edge of batch, in batch order, without self-loops: applying them
+/// in any order gives the same graph as applying batch in order
+std::vector<EdgeUpdate> lastUpdates(const std::vector<EdgeUpdate> &batch);
+
+/// Edge u-v seen at time t
+struct TemporalEdge {
+    v_int u, v;
+    int64_t t;
+};
+
+/// A timestamped edge stream, sorted by time
+struct TemporalEdges {
+    v_int n = 0; // largest vertex id + 1
+    std::vector<TemporalEdge> edges;
+};
+
+/// "u v t" lines, t an integer (e.g. seconds). The same edge may appear at several times.
+TemporalEdges readTemporalEdges(const std::string &path);
+
+/// Windows [start, start + window) sliding by slide over a stream, starting at its first
+/// edge. Turns each move of the window into the batch of updates for DynamicGraph: an edge
+/// is in the graph while any of its occurrences is in the window.
+class SlidingWindow {
+public:
+    SlidingWindow(const TemporalEdges &stream, int64_t window, int64_t slide);
+
+    /// Move to the next window and set batch to the edges it adds and removes. False once the
+    /// window has passed the last edge.
+    bool next(std::vector<EdgeUpdate> &batch);
+    int64_t start() const {
+        return begin;
+    }
+    int64_t end() const {
+        return begin + window;
+    }
+    /// Distinct edges in the current window
+    int64_t edges() const {
+        return multiplicity.size();
+    }
+
+private:
+    const TemporalEdges &stream;
+    int64_t window, slide, begin;
+    bool first = true;
+    size_t arrived = 0, expired = 0; // stream edges that entered / left the window so far
+    // occurrences in the window of each edge, and the counts before the current move
+    std::unordered_map<uint64_t, int32_t> multiplicity, before;
+};
+
+/// Adjacency lists that take edge insertions and deletions, with core numbers kept up to
+/// date locally: only vertices with the core number r of the lower endpoint, connected to it
+/// through such vertices, can change, and by one at most. An insertion only searches
+/// through those with more than r neighbours of core >= r, a deletion only from vertices
+/// that dropped.
+///
+/// Vertices are ordered by (core number, id), which is a degeneracy ordering up to ties and
+/// only changes around vertices whose core number changed.
+class DynamicGraph {
+public:
+    DynamicGraph(v2::Graph &g, std::vector<v_int> coreNumber);
+
+    v_int size() const {
+        return adj.size();
+    }
+    const std::vector<v_int> &neighbours(v_int u) const {
+        return adj[u];
+    }
+    v_int degree(v_int u) const {
+        return adj[u].size();
+    }
+    int64_t nEdges() const {
+        return m;
+    }
+    /// u comes after v in the ordering
+    bool later(v_int u, v_int v) const {
+        return core[u] != core[v] ? core[u] > core[v] : u > v;
+    }
+    bool adjacent(v_int u, v_int v) const;
+
+    /// False if the edge is a self-loop or already there
+    bool insert(v_int u, v_int v);
+    /// False if the edge isn't there
+    bool erase(v_int u, v_int v);
+    /// Apply a whole batch, at most one update per edge (see lastUpdates), and recompute
+    /// every core number by peeling, which is faster than one update at a time once the
+    /// batch is a large part of the graph
+    void rebuild(const std::vector<EdgeUpdate> &batch);
+    /// Vertices whose core number changed since the last call
+    std::vector<v_int> takeCoreChanges();
+    const std::vector<v_int> &coreNumbers() const {
+        return core;
+    }
+
+    v2::Graph toGraph() const;
+
+private:
+    // neighbours of u with core number >= r, not counting those marked as dropped
+    v_int countAtLeast(v_int u, v_int r) const;
+    void changeCore(v_int u, v_int core);
+
+    std::vector<std::vector<v_int>> adj;
+    int64_t m = 0;
+    std::vector<v_int> core;
+    std::vector<v_int> changed;
+    std::vector<uint8_t> isChanged;
+    // traversal scratch
+    std::vector<v_int> visited, count, evict;
+    std::vector<uint8_t> mark;
+};
+
+/// Keeps the ego loop's incumbent up to date while the graph changes: after a batch only the
+/// ego networks that may differ are solved again. Those are rooted at the endpoints of
+/// changed edges, at their common neighbours (whose ego network gained or lost the edge) and
+/// at vertices whose core number changed and their neighbours (whose forward neighbourhood
+/// changed). With twoHop an ego network reaches two hops, so all roots within two hops of a
+/// changed edge or vertex are solved again.
+///
+/// A batch large enough to rebuild the graph still only solves those roots again. Deleting an
+/// edge inside the incumbent can break it; then every root is solved again.
+/// Model is the same as for egoLoop.
+template<class Model>
+class DynamicSolver {
+public:
+    DynamicSolver(DynamicGraph &g, const Model &model, bool twoHop, std::vector<v_id> initial)
+        : g(g), model(model), twoHop(twoHop), incumbent(std::move(initial)),
+          inIncumbent(g.size(), 0), affected(g.size(), 0) {
+        for (v_id v : incumbent) { inIncumbent[v] = 1; }
+    }
+
+    const std::vector<v_id> &solution() const {
+        return incumbent;
+    }
+
+    /// Solve the ego network of every vertex
+    void solveAll() {
+        std::vector<v_int> roots(g.size());
+        for (v_int u = 0; u < g.size(); u++) { roots[u] = u; }
+        solveRoots(roots);
+    }
+
+    /// Apply a batch of updates and solve the ego networks it changed. Returns the number of
+    /// roots solved again.
+    int64_t apply(const std::vector<EdgeUpdate> &updates) {
+        // the same graph whether the batch is applied one update at a time or rebuilt
+        std::vector<EdgeUpdate> batch = lastUpdates(updates);
+        // the updates that changed the graph
+        std::vector<EdgeUpdate> applied;
+        if (int64_t(batch.size()) * REBUILD_RATIO > g.nEdges()) {
+            // in bulk, recomputing every core number by peeling
+            for (const EdgeUpdate &update : batch) {
+                if (update.insert != g.adjacent(update.u, update.v)) { applied.push_back(update); }
+            }
+            g.rebuild(applied);
+        } else {
+            for (const EdgeUpdate &update : batch) {
+                auto [insert, u, v] = update;
+                if (insert ? g.insert(u, v) : g.erase(u, v)) { applied.push_back(update); }
+            }
+        }
+
+        bool broken = false;
+        for (auto [insert, u, v] : applied) {
+            if (!insert && inIncumbent[u] && inIncumbent[v]) { broken = true; }
+        }
+        std::vector<v_int> coreChanges = g.takeCoreChanges();
+        if (broken) {
+            setIncumbent({});
+            solveAll();
+            return g.size();
+        }
+
+        std::vector<v_int> roots;
+        auto add = [&](v_int u) {
+            if (!affected[u]) {
+                affected[u] = 1;
+                roots.push_back(u);
+            }
+        };
+        for (auto [insert, u, v] : applied) {
+            add(u);
+            add(v);
+            // common neighbours: look the shorter list up in the longer, which may be a hub's,
+            // skipping roots already found (most of them after a large batch)
+            v_int shorter = g.degree(u) <= g.degree(v) ? u : v, longer = u ^ v ^ shorter;
+            for (v_int x : g.neighbours(shorter)) {
+                if (!affected[x] && g.adjacent(longer, x)) { add(x); }
+            }
+        }
+        for (v_int x : coreChanges) { add(x); }
+        if (twoHop) {
+            // two rings around the endpoints, common neighbours and changed vertices
+            for (size_t ring = 0, begin = 0; ring < 2; ring++) {
+                size_t end = roots.size();
+                for (size_t i = begin; i < end; i++) {
+                    for (v_int y : g.neighbours(roots[i])) { add(y); }
+                }
+                begin = end;
+            }
+        } else {
+            for (v_int x : coreChanges) {
+                for (v_int y : g.neighbours(x)) { add(y); }
+            }
+        }
+        for (v_int u : roots) { affected[u] = 0; }
+
+        // the end of the ordering first, where large solutions raise the bound early
+        std::sort(roots.begin(), roots.end(), [&](v_int a, v_int b) { return g.later(a, b); });
+        solveRoots(roots);
+        return roots.size();
+    }
+
+private:
+    // batches with more than 1 / REBUILD_RATIO of the edges rebuild the graph
+    static constexpr int64_t REBUILD_RATIO = 16;
+
+    void setIncumbent(std::vector<v_id> solution) {
+        for (v_id v : incumbent) { inIncumbent[v] = 0; }
+        incumbent = std::move(solution);
+        for (v_id v : incumbent) { inIncumbent[v] = 1; }
+    }
+
+    // same collection and pruning as egoLoop, with the ordering of the dynamic graph
+    void solveRoots(const std::vector<v_int> &roots) {
+        std::atomic<v_int> best = incumbent.size();
+#pragma omp parallel
+        {
+            EpochMap<v_int> &position = scratch().position;
+            position.resize(g.size());
+            std::vector<v_int> common(twoHop ? g.size() : 0, 0);
+            std::vector<v_int> vertices, twoHopSeen;
+            std::vector<std::pair<v_int, v_int>> edges;
+
+#pragma omp for schedule(dynamic, 16)
+            for (size_t r = 0; r < roots.size(); r++) {
+                v_int u = roots[r];
+                v_int bestSize = best.load(std::memory_order_relaxed);
+                stats().count(Counter::EgoVisited);
+                if (model.skipRoot(g.degree(u), bestSize)) {
+                    stats().count(Counter::EgoPrunedDegree);
+                    continue;
+                }
+                vertices.assign(1, u);
+                position.clear();
+                position.set(u, 0);
+                for (v_int v : g.neighbours(u)) {
+                    if (!g.later(v, u) || model.skipCandidate(g.degree(v), bestSize)) { continue; }
+                    position.set(v, vertices.size());
+                    vertices.push_back(v);
+                }
+                if (twoHop) {
+                    v_int neighbours = vertices.size();
+                    for (v_int j = 1; j < neighbours; j++) {
+                        for (v_int w : g.neighbours(vertices[j])) {
+                            if (!g.later(w, u) || position.get(w, -1) >= 0) { continue; }
+                            if (common[w]++ == 0) { twoHopSeen.push_back(w); }
+                        }
+                    }
+                    v_int minCommon = model.minCommon(bestSize);
+                    for (v_int w : twoHopSeen) {
+                        if (common[w] >= minCommon && !model.skipCandidate(g.degree(w), bestSize)) {
+                            position.set(w, vertices.size());
+                            vertices.push_back(w);
+                        }
+                        common[w] = 0;
+                    }
+                    twoHopSeen.clear();
+                }
+                stats().egoSize(vertices.size());
+
+                if (v_int(vertices.size()) > bestSize) {
+                    edges.clear();
+                    for (v_int i = 0; i < v_int(vertices.size()); i++) {
+                        for (v_int w : g.neighbours(vertices[i])) {
+                            if (v_int j = position.get(w, -1); j > i) { edges.emplace_back(i, j); }
+                        }
+                    }
+                    std::vector<v_id> newSolution;
+                    auto boundOrSolve = [&](auto subgraph) {
+                        if (model.upperBound(subgraph) <= bestSize) { return true; }
+                        newSolution = model.solve(subgraph);
+                        return false;
+                    };
+                    v_int n = vertices.size();
+                    bool pruned = n <= v2::SMALL_GRAPH_MAX
+                                      ? boundOrSolve(v2::SmallGraph::fromEdges(n, edges))
+                                      : boundOrSolve(v2::Graph::fromEdges(n, edges));
+                    if (pruned) {
+                        stats().count(Counter::EgoPrunedBound);
+                    } else {
+                        stats().count(Counter::EgoSolved);
+                        if (v_int(newSolution.size()) > best.load(std::memory_order_relaxed)) {
+                            for (auto &v : newSolution) { v = vertices[v]; }
+#pragma omp critical(gm_dynamic_incumbent)
+                            if (v_int(newSolution.size()) > best.load(std::memory_order_relaxed)) {
+                                best.store(newSolution.size(), std::memory_order_relaxed);
+                                setIncumbent(std::move(newSolution));
+                                stats().count(Counter::EgoImproved);
+                            }
+                        }
+                    }
+                } else {
+                    stats().count(Counter::EgoPrunedSize);
+                }
+            }
+        }
+    }
+
+    DynamicGraph &g;
+    Model model;
+    bool twoHop;
+    std::vector<v_id> incumbent;
+    std::vector<uint8_t> inIncumbent, affected;
+};
+
+/// Solve on g, then apply the batches of updatesPath one at a time and keep the solution up
+/// to date, reporting it after each batch. coreNumber and initial come from peeling g. g is
+/// replaced by the graph after the last batch.
+template<class Model>
+std::vector<v_id> solveDynamic(v2::Graph &g, const Model &model, bool twoHop,
+                               std::vector<v_int> coreNumber, std::vector<v_id> initial,
+                               const std::string &updatesPath) {
+    auto batches = readUpdates(updatesPath);
+    for (const auto &batch : batches) {
+        for (auto [insert, u, v] : batch) {
+            GM_ASSERT(0 <= u && u < g.size() && 0 <= v && v < g.size(),
+                      "solveDynamic: update of a vertex outside the graph");
+        }
+    }
+    DynamicGraph dynamic{g, std::move(coreNumber)};
+    DynamicSolver solver{dynamic, model, twoHop, std::move(initial)};
+    solver.solveAll();
+    std::cout << "[dynamic] " << model.name << " initial size = " << solver.solution().size()
+              << std::endl;
+
+    int64_t resolved = 0;
+    for (size_t i = 0; i < batches.size(); i++) {
+        auto start = std::chrono::steady_clock::now();
+        int64_t roots = solver.apply(batches[i]);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        resolved += roots;
+        std::cout << "[dynamic] batch " << i << ": " << batches[i].size() << " updates, " << roots
+                  << " roots solved again, size = " << solver.solution().size() << ", "
+                  << elapsed.count() << " ms" << std::endl;
+    }
+    stats().set("dynamic_batches", batches.size());
+    stats().set("dynamic_roots_resolved", resolved);
+    g = dynamic.toGraph();
+    return solver.solution();
+}
+
+/// Solve every window of the stream, starting from the empty graph and updating the solution
+/// as edges enter and leave (see DynamicSolver). Reports the best solution of each window;
+/// returns the one of the last window, and sets last to its graph.
+template<class Model>
+std::vector<v_id> solveTemporal(const TemporalEdges &stream, const Model &model, bool twoHop,
+                                int64_t window, int64_t slide, v2::Graph &last) {
+    v2::Graph empty = v2::Graph::fromEdges(stream.n, {});
+    DynamicGraph dynamic{empty, std::vector<v_int>(stream.n, 0)};
+    DynamicSolver solver{dynamic, model, twoHop, {}};
+    SlidingWindow windows{stream, window, slide};
+    std::vector<EdgeUpdate> batch;
+    std::string json = "[";
+    int64_t count = 0;
+    while (windows.next(batch)) {
+        auto begin = std::chrono::steady_clock::now();
+        int64_t roots = solver.apply(batch);
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - begin;
+        size_t size = solver.solution().size();
+        std::cout << "[window] [" << windows.start() << ", " << windows.end()
+                  << "): " << windows.edges() << " edges, " << roots
+                  << " roots solved, size = " << size << ", " << elapsed.count() << " ms"
+                  << std::endl;
+        json += std::string(count ? ", " : "") + "{\"start\": " + std::to_string(windows.start()) +
+                ", \"edges\": " + std::to_string(windows.edges()) +
+                ", \"size\": " + std::to_string(size) + "}";
+        count++;
+    }
+    stats().set("windows", count);
+    stats().setJson("window_sizes", json + "]");
+    last = dynamic.toGraph();
+    return solver.solution();
+}
+
+} // namespace gm
+
+#endif // GM_DYNAMIC_HPP
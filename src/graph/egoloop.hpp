@@ -0,0 +1,604 @@
+#ifndef GM_EGOLOOP_HPP
+#define GM_EGOLOOP_HPP
+
+#include <omp.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/peel.hpp"
+#include "graph/truss.hpp"
+#include "graph/types.hpp"
+#include "perf.hpp"
+#include "queue.hpp"
+#include "scratch.hpp"
+#include "shard.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+
+namespace gm {
+
+/// Rounds of the ego loop, each followed by a truss pruning pass
+inline int64_t EGO_ROUNDS = 16;
+/// Threads that only collect and build ego networks, for the others to solve; 0 runs both
+/// on every thread
+inline int64_t EGO_PIPELINE = 0;
+/// Subgraph bytes an extractor hands over at once, about what a solver keeps in cache
+inline int64_t PIPELINE_BATCH_BYTES = 256 << 10;
+
+/// An ego subgraph, with 16-bit ids unless it has more than v2::SMALL_GRAPH_MAX vertices
+using EgoSubgraph = std::variant<v2::SmallGraph, v2::Graph>;
+
+inline EgoSubgraph buildEgoSubgraph(v2::Graph &g, const std::vector<v_int> &vertices) {
+    if (v_int(vertices.size()) <= v2::SMALL_GRAPH_MAX) {
+        return v2::subgraphDegen<v2::SmallGraph>(g, vertices);
+    }
+    return v2::subgraphDegen<v2::Graph>(g, vertices);
+}
+
+/// The models egoLoop solves the ego networks for, each with its own incumbent. An ego network
+/// is collected with the weakest filters of the models that keep its root and built once; each
+/// model only runs its kernel on it while its own bound beats its own incumbent, and on the
+/// vertices its own filters keep. Masks have bit i set for model i.
+template<class... Models>
+struct EgoModels {
+    static constexpr size_t N = sizeof...(Models);
+    static_assert(N >= 1 && N <= 8, "EgoModels: one bit of a uint8_t per model");
+    using Sizes = std::array<v_int, N>;
+    using Solutions = std::array<std::vector<v_id>, N>;
+    std::tuple<Models...> models;
+
+    /// f(model, i) for each model in turn
+    template<class F>
+    void each(F f) const {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (f(std::get<I>(models), I), ...);
+        }(std::index_sequence_for<Models...>{});
+    }
+    /// Whether f(model, i) holds for every model
+    template<class F>
+    bool all(F f) const {
+        bool result = true;
+        each([&](const auto &model, size_t i) { result = result && f(model, i); });
+        return result;
+    }
+    bool skipRest(v_int later, const Sizes &best) const {
+        return all([&](const auto &model, size_t i) { return model.skipRest(later, best[i]); });
+    }
+    /// The models keeping a root of this degree
+    uint8_t roots(v_int degree, const Sizes &best) const {
+        uint8_t mask = 0;
+        each([&](const auto &model, size_t i) {
+            if (!model.skipRoot(degree, best[i])) { mask |= 1u << i; }
+        });
+        return mask;
+    }
+    /// The models of among keeping a neighbour of the root of this degree
+    uint8_t keeps(uint8_t among, v_int degree, const Sizes &best) const {
+        uint8_t mask = 0;
+        each([&](const auto &model, size_t i) {
+            if (((among >> i) & 1) && !model.skipCandidate(degree, best[i])) { mask |= 1u << i; }
+        });
+        return mask;
+    }
+    /// and a two-hop neighbour with this many common neighbours with the root
+    uint8_t keeps(uint8_t among, v_int degree, v_int common, const Sizes &best) const {
+        uint8_t mask = 0;
+        each([&](const auto &model, size_t i) {
+            if (((among >> i) & 1) && common >= model.minCommon(best[i]) &&
+                !model.skipCandidate(degree, best[i])) {
+                mask |= 1u << i;
+            }
+        });
+        return mask;
+    }
+    v_int minSupport(const Sizes &best) const {
+        v_int support = std::numeric_limits<v_int>::max();
+        each([&](const auto &model, size_t i) {
+            support = std::min(support, model.minSupport(best[i]));
+        });
+        return support;
+    }
+    v_int minCommon(uint8_t among, const Sizes &best) const {
+        v_int common = std::numeric_limits<v_int>::max();
+        each([&](const auto &model, size_t i) {
+            if ((among >> i) & 1) { common = std::min(common, model.minCommon(best[i])); }
+        });
+        return common;
+    }
+};
+
+/// An ego network built by egoLoop, waiting to be solved
+template<size_t N>
+struct EgoNet {
+    v_id root;
+    std::vector<v_id> vertices; // ranked ids of the subgraph vertices
+    std::vector<uint8_t> keptBy; // the models keeping each vertex, empty if all keep all
+    EgoSubgraph subgraph;
+    std::array<v_int, N> bound; // of each model, 0 for those that skip the root
+    int64_t traceStart, traceCollected, traceBuilt;
+
+    int64_t bytes() const {
+        int64_t graph = std::visit([](const auto &sub) { return sub.bytes(); }, subgraph);
+        return graph + vertices.capacity() * sizeof(v_id) + keptBy.capacity();
+    }
+};
+
+/// Ego network loop shared by kPlexV2, kDefDegenV2, quasiClique, pseudoClique and allModels.
+///
+/// For every vertex u, collect u and its neighbours later in the degeneracy ordering
+/// (plus their later neighbours sharing enough neighbours with u, with twoHop), build the
+/// induced subgraph and run the model's kernel on it, keeping the largest solution. Works on
+/// the ranked graph, where "later in the ordering" is a smaller id; initial and the result
+/// use input graph ids.
+///
+/// Roots are visited by ranked id, from the end of the ordering, so in decreasing core number
+/// and the dense part of the graph, where large solutions are, comes first. Every other
+/// vertex of a solution found from u is later than u, so u has at most as many neighbours in
+/// it as later neighbours. Once skipRest rules out the most later neighbours of any root not
+/// visited yet (at most their core number), the loop stops.
+///
+/// Vertices are processed in parallel with OpenMP, in rounds; between
+/// rounds edges that can't be in a solution better than the incumbent are deleted by a
+/// TrussPruner and the incumbent size is exchanged with the other shards. Only roots of
+/// this Shard are visited; sharing the incumbent with the other shards needs a single model.
+///
+/// With EGO_PIPELINE extractor threads, collecting and building (random accesses to g) is
+/// split from solving (compute on a subgraph that fits in cache): extractors push batches of
+/// ego networks to a bounded queue and wait while it is full, the other threads pop and
+/// solve them, and drop those whose bound the incumbent has reached in the meantime.
+///
+/// A Model provides
+///   const char *name;
+///   bool skipRoot(v_int degree, v_int best) const;      // u can't be in a better solution
+///   bool skipCandidate(v_int degree, v_int best) const; // v / w can't be in a better solution
+///   bool skipRest(v_int later, v_int best) const; // nor a root with this many later neighbours
+///   v_int minSupport(v_int best) const; // triangles an edge of a better solution is in
+///   v_int minCommon(v_int best) const;  // common neighbours of a non-adjacent pair in one
+///   v_int upperBound(G &subgraph) const; // no solution in subgraph is larger
+///   std::vector<v_id> solve(G &subgraph) const;
+/// with the last two templates over G, v2::Graph or v2::SmallGraph. With EgoModels, the
+/// solutions of all its models are found in one pass, from initial.
+template<class... Models>
+typename EgoModels<Models...>::Solutions egoLoop(
+    RankedGraph &ranked, const EgoModels<Models...> &models, bool twoHop,
+    typename EgoModels<Models...>::Solutions initial) {
+    constexpr size_t N = EgoModels<Models...>::N;
+    using Sizes = typename EgoModels<Models...>::Sizes;
+    GM_ASSERT(N == 1 || Shard::boundPath.empty(), "egoLoop: --bound-file needs a single model");
+    v2::Graph &g = ranked.graph;
+    v_int size = g.size();
+    if (HubRows::minDegree > 0 && !g.hubs) { g.buildHubs(HubRows::minDegree); }
+    auto solutions = std::move(initial);
+    std::array<std::atomic<v_int>, N> best;
+    for (size_t i = 0; i < N; i++) { best[i] = solutions[i].size(); }
+    auto loadBest = [&] {
+        Sizes sizes;
+        for (size_t i = 0; i < N; i++) { sizes[i] = best[i].load(std::memory_order_relaxed); }
+        return sizes;
+    };
+
+    // laterMax[r]: the most later neighbours of a root from r on, non-increasing in r. The loop
+    // stops at exitRoot, the first root whose laterMax skipRest rules out.
+    std::vector<v_int> laterMax(size + 1, 0);
+    auto boundLater = [&] {
+#pragma omp parallel for schedule(static)
+        for (v_id r = 0; r < size; r++) {
+            laterMax[r] = std::lower_bound(g.edges(r), g.edgesEnd(r), r) - g.edges(r);
+        }
+        for (v_id r = size; r-- > 0;) { laterMax[r] = std::max(laterMax[r], laterMax[r + 1]); }
+    };
+    boundLater();
+    std::atomic<v_id> exitRoot = size;
+    bool stopped = false;
+
+    std::optional<TrussPruner> truss;
+    v_int trussSupport = 0;
+    int64_t trussRemoved = 0;
+    auto prune = [&] {
+        v_int minSupport = models.minSupport(loadBest());
+        if (!TrussPruner::enabled || minSupport <= trussSupport) { return; }
+        if (!truss) { truss.emplace(g); }
+        int64_t removed = truss->prune(minSupport);
+        trussRemoved += removed;
+        trussSupport = minSupport;
+        if (removed > 0) { boundLater(); }
+    };
+    // the best size any shard found, which may be larger than our own solution
+    auto shareBound = [&] {
+        if (Shard::boundPath.empty()) { return; }
+        v_int shared = Shard::exchangeBound(solutions[0].size());
+        if (shared > best[0].load(std::memory_order_relaxed)) { best[0].store(shared); }
+    };
+    shareBound();
+    prune();
+    bool between = TrussPruner::enabled || !Shard::boundPath.empty();
+    const int64_t rounds = between ? EGO_ROUNDS : 1;
+
+    // split from the team the parallel region gets, which may be smaller than
+    // omp_get_max_threads(); with fewer than 2 threads there is no pipeline
+    int extractors = 0;
+    bool pipelined = false;
+    // pipeline state: the next root to extract in this round, the extractors still running
+    // and batches of ego networks waiting to be solved
+    std::atomic<v_id> nextRoot = 0;
+    std::atomic<int> activeExtractors = 0;
+    std::optional<BoundedQueue<std::vector<EgoNet<N>>>> queue;
+    std::atomic<int64_t> queuedBytes = 0, queuedPeak = 0;
+
+#pragma omp parallel
+    {
+#pragma omp single
+        {
+            int threads = omp_get_num_threads();
+            extractors = std::min<int64_t>(EGO_PIPELINE, threads - 1);
+            pipelined = extractors > 0;
+            activeExtractors = extractors;
+            if (pipelined) { queue.emplace(2 * (threads - extractors)); }
+        }
+        PerfScope perfScope{PerfPhase::EgoLoop};
+        EpochMarks<> &included = scratch().included;
+        included.resize(size);
+        std::vector<v_id> vertices;
+        std::vector<uint8_t> keptBy; // models keeping each of vertices
+        // common neighbours of u and each two-hop candidate, and the candidates seen
+        std::vector<v_int> common(twoHop ? size : 0, 0);
+        std::vector<v_id> twoHopSeen;
+        // with probeHubs: the neighbours of u whose hub rows are probed, and for every candidate
+        // seen the first neighbour it was seen from
+        std::vector<v_int> hubNeighbours, firstSeen;
+        std::vector<std::pair<v_int, v_id>> seenOrder, hubPrefixes;
+        TrackedBytes scratchBytes{Memory::EgoScratch, included.bytes()};
+        const bool tracing = Trace::enabled;
+        const bool extractor = pipelined && omp_get_thread_num() < extractors;
+        int64_t loopStart = tracing ? Trace::now() : 0;
+
+        // Collect the candidates of the ego network of u into vertices, build it and bound
+        // it. Returns it if it may hold a solution of some model larger than bestSize.
+        auto extract = [&](v_id u, const Sizes &bestSize) -> std::optional<EgoNet<N>> {
+            stats().count(Counter::EgoVisited);
+            const uint8_t open = models.roots(g.degree(u), bestSize);
+            if (open == 0) {
+                stats().count(Counter::EgoPrunedDegree);
+                return std::nullopt;
+            }
+            int64_t traceStart = tracing ? Trace::now() : 0, traceBuilt = 0;
+            PhaseTimer collectTimer{Phase::Collect};
+            vertices.clear();
+            vertices.push_back(u);
+            keptBy.clear();
+            keptBy.push_back(open);
+            uint8_t keptByAll = open;
+            included.clear();
+            included.insert(u);
+            // Add neighbours to subgraph
+            for (v_id v : g.iterNeighbours(u)) {
+                if (v > u) { break; }
+                uint8_t keep = models.keeps(open, g.degree(v), bestSize);
+                if (keep == 0) { continue; }
+                included.insert(v);
+                vertices.push_back(v);
+                keptBy.push_back(keep);
+                keptByAll &= keep;
+            }
+            // and two-hop neighbours, counting the neighbours they share with u on the way
+            if (twoHop) {
+                v_int neighbours = vertices.size();
+                v_int minCommon = models.minCommon(open, bestSize);
+                // A candidate adjacent to none of the other neighbours of u has at most as many
+                // common neighbours with u as there are probed hubs. Below minCommon, skip the
+                // lists of the k hubs with the longest prefixes when probing their rows for the
+                // candidates the other lists find is cheaper than scanning them.
+                hubNeighbours.clear();
+                if (g.hubs) {
+                    hubPrefixes.clear();
+                    int64_t total = 0; // ids the scan reads, at most
+                    for (v_int j = 1; j < neighbours; j++) {
+                        v_id v = vertices[j];
+                        if (!g.isHub(v)) {
+                            total += g.degree(v);
+                            continue;
+                        }
+                        v_int prefix = std::upper_bound(g.edges(v), g.edgesEnd(v), u) - g.edges(v);
+                        hubPrefixes.emplace_back(prefix, j);
+                        total += prefix;
+                    }
+                    std::sort(hubPrefixes.begin(), hubPrefixes.end(), std::greater<>());
+                    int64_t bestCost = total, skipped = 0;
+                    size_t k = 0;
+                    for (size_t i = 0; i < hubPrefixes.size() && v_int(i + 1) < minCommon; i++) {
+                        skipped += hubPrefixes[i].first;
+                        int64_t probes = HubRows::PROBE_COST * int64_t(i + 1);
+                        int64_t cost = (1 + probes) * (total - skipped);
+                        if (cost < bestCost) {
+                            bestCost = cost;
+                            k = i + 1;
+                        }
+                    }
+                    for (size_t i = 0; i < k; i++) {
+                        hubNeighbours.push_back(hubPrefixes[i].second);
+                    }
+                    std::sort(hubNeighbours.begin(), hubNeighbours.end());
+                }
+                bool probeHubs = !hubNeighbours.empty();
+                size_t nextHub = 0;
+                for (v_int j = 1; j < neighbours; j++) {
+                    if (nextHub < hubNeighbours.size() && hubNeighbours[nextHub] == j) {
+                        nextHub++;
+                        continue;
+                    }
+                    for (v_id w : g.iterNeighbours(vertices[j])) {
+                        if (w > u) { break; }
+                        if (included.contains(w)) { continue; }
+                        if (common[w]++ == 0) {
+                            twoHopSeen.push_back(w);
+                            if (probeHubs) { firstSeen.push_back(j); }
+                        }
+                    }
+                }
+                if (probeHubs) {
+                    // Put the candidates back in the order scanning every list finds them: by
+                    // the first neighbour they are adjacent to, then by id
+                    seenOrder.clear();
+                    for (size_t i = 0; i < twoHopSeen.size(); i++) {
+                        v_id w = twoHopSeen[i];
+                        v_int first = firstSeen[i];
+                        for (v_int j : hubNeighbours) {
+                            if (g.hubs->contains(vertices[j], w)) {
+                                common[w]++;
+                                first = std::min(first, j);
+                            }
+                        }
+                        seenOrder.emplace_back(first, w);
+                    }
+                    std::sort(seenOrder.begin(), seenOrder.end());
+                    for (size_t i = 0; i < seenOrder.size(); i++) {
+                        twoHopSeen[i] = seenOrder[i].second;
+                    }
+                    firstSeen.clear();
+                }
+                for (v_id w : twoHopSeen) {
+                    uint8_t keep = common[w] >= minCommon
+                                       ? models.keeps(open, g.degree(w), common[w], bestSize)
+                                       : 0;
+                    if (keep != 0) {
+                        included.insert(w);
+                        vertices.push_back(w);
+                        keptBy.push_back(keep);
+                        keptByAll &= keep;
+                    }
+                    common[w] = 0;
+                }
+                twoHopSeen.clear();
+            }
+
+            collectTimer.stop();
+            stats().egoSize(vertices.size());
+            int64_t lists = common.capacity() + vertices.capacity() + twoHopSeen.capacity() +
+                            hubNeighbours.capacity() + firstSeen.capacity() +
+                            2 * (seenOrder.capacity() + hubPrefixes.capacity());
+            scratchBytes.update(included.bytes() + lists * sizeof(v_id) + keptBy.capacity());
+            int64_t traceCollected = tracing ? Trace::now() : 0;
+
+            v_int smallestBest = std::numeric_limits<v_int>::max();
+            for (size_t i = 0; i < N; i++) {
+                if ((open >> i) & 1) { smallestBest = std::min(smallestBest, bestSize[i]); }
+            }
+            if (v_int(vertices.size()) <= smallestBest) {
+                stats().count(Counter::EgoPrunedSize);
+                if (tracing) {
+                    trace().ego(ranked.original[u], vertices.size(), traceStart, traceCollected, 0,
+                                0);
+                }
+                return std::nullopt;
+            }
+            PhaseTimer buildTimer{Phase::Build};
+            EgoSubgraph subgraph = buildEgoSubgraph(g, vertices);
+            buildTimer.stop();
+            if (tracing) { traceBuilt = Trace::now(); }
+            PhaseTimer boundTimer{Phase::Bound};
+            // bounds on the whole network also bound the part a model keeps
+            std::array<v_int, N> bound{};
+            models.each([&](const auto &model, size_t i) {
+                if (!((open >> i) & 1)) { return; }
+                bound[i] = std::visit([&](auto &sub) { return model.upperBound(sub); }, subgraph);
+            });
+            boundTimer.stop();
+            if (models.all([&](const auto &, size_t i) { return bound[i] <= bestSize[i]; })) {
+                stats().count(Counter::EgoPrunedBound);
+                if (tracing) {
+                    trace().ego(ranked.original[u], vertices.size(), traceStart, traceCollected,
+                                traceBuilt, Trace::now());
+                }
+                return std::nullopt;
+            }
+            if (keptByAll == open) { keptBy.clear(); }
+            return EgoNet<N>{.root = u,
+                             .vertices = vertices,
+                             .keptBy = keptBy,
+                             .subgraph = std::move(subgraph),
+                             .bound = bound,
+                             .traceStart = traceStart,
+                             .traceCollected = traceCollected,
+                             .traceBuilt = traceBuilt};
+        };
+
+        // Whether no root from r on can lead to a better solution
+        auto pastExit = [&](v_id r, const Sizes &bestSize) {
+            v_id exit = exitRoot.load(std::memory_order_relaxed);
+            if (r >= exit) { return true; }
+            if (!models.skipRest(laterMax[r], bestSize)) { return false; }
+            while (r < exit && !exitRoot.compare_exchange_weak(exit, r)) {}
+            return true;
+        };
+
+        // Run the kernels on an ego network, except those whose incumbent caught up with their
+        // bound while it was queued, and keep better solutions. A model that does not keep
+        // every vertex gets the subgraph of those it keeps, bounded again.
+        auto solve = [&](EgoNet<N> &ego) {
+            auto open = [&](size_t i) {
+                return ego.bound[i] > best[i].load(std::memory_order_relaxed);
+            };
+            if (models.all([&](const auto &, size_t i) { return !open(i); })) {
+                stats().count(Counter::EgoCancelled);
+                return;
+            }
+            TrackedBytes subgraphBytes{Memory::Subgraph, ego.bytes()};
+            int64_t traceSolving = tracing ? Trace::now() : 0;
+            PhaseTimer solveTimer{Phase::Solve};
+            models.each([&](const auto &model, size_t i) {
+                if (!open(i)) { return; }
+                const std::vector<v_id> *vertices = &ego.vertices;
+                EgoSubgraph *subgraph = &ego.subgraph;
+                std::vector<v_id> kept;
+                std::optional<EgoSubgraph> own;
+                if (!ego.keptBy.empty()) {
+                    for (size_t j = 0; j < ego.vertices.size(); j++) {
+                        if ((ego.keptBy[j] >> i) & 1) { kept.push_back(ego.vertices[j]); }
+                    }
+                }
+                if (!kept.empty() && kept.size() < ego.vertices.size()) {
+                    v_int incumbent = best[i].load(std::memory_order_relaxed);
+                    if (v_int(kept.size()) <= incumbent) { return; }
+                    own = buildEgoSubgraph(g, kept);
+                    auto bound = [&](auto &sub) { return model.upperBound(sub); };
+                    if (std::visit(bound, *own) <= incumbent) { return; }
+                    vertices = &kept;
+                    subgraph = &*own;
+                }
+                std::vector<v_id> newSolution =
+                    std::visit([&](auto &sub) { return model.solve(sub); }, *subgraph);
+                if (v_int(newSolution.size()) <= best[i].load(std::memory_order_relaxed)) {
+                    return;
+                }
+                // Map subgraph vertices back
+                for (auto &v : newSolution) { v = ranked.original[(*vertices)[v]]; }
+#pragma omp critical(gm_ego_incumbent)
+                if (v_int(newSolution.size()) > best[i].load(std::memory_order_relaxed)) {
+                    solutions[i] = std::move(newSolution);
+                    best[i].store(solutions[i].size(), std::memory_order_relaxed);
+                    stats().count(Counter::EgoImproved);
+                    if (tracing) { trace().instant("improved", solutions[i].size()); }
+                }
+            });
+            solveTimer.stop();
+            stats().count(Counter::EgoSolved);
+            if (tracing) {
+                int64_t traceSolved = Trace::now();
+                if (pipelined) {
+                    if (traceSolved - traceSolving >= Trace::minNs) {
+                        trace().complete("solve", traceSolving, traceSolved,
+                                         ranked.original[ego.root], ego.vertices.size());
+                    }
+                } else {
+                    trace().ego(ranked.original[ego.root], ego.vertices.size(), ego.traceStart,
+                                ego.traceCollected, ego.traceBuilt, traceSolved);
+                }
+            }
+        };
+
+        for (int64_t round = 0; round < rounds; round++) {
+            const v_id roundStart = size * round / rounds, roundEnd = size * (round + 1) / rounds;
+            if (!pipelined) {
+#pragma omp for schedule(dynamic, 64)
+                for (v_id u = roundStart; u < roundEnd; u++) {
+                    Sizes bestSize = loadBest();
+                    if (pastExit(u, bestSize) || !Shard::owns(u)) { continue; }
+                    auto ego = extract(u, bestSize);
+                    if (ego) { solve(*ego); }
+                }
+            } else if (extractor) {
+                // fill batches of about PIPELINE_BATCH_BYTES, waiting while the queue is full
+                std::vector<EgoNet<N>> batch;
+                int64_t batchBytes = 0;
+                auto flush = [&] {
+                    int64_t queued = queuedBytes.fetch_add(batchBytes) + batchBytes;
+                    int64_t peak = queuedPeak.load();
+                    while (queued > peak && !queuedPeak.compare_exchange_weak(peak, queued)) {}
+                    while (!queue->tryPush(batch)) { std::this_thread::yield(); }
+                    batch.clear();
+                    batchBytes = 0;
+                };
+                for (v_id chunk; (chunk = nextRoot.fetch_add(64)) < roundEnd;) {
+                    for (v_id u = chunk; u < std::min(chunk + 64, roundEnd); u++) {
+                        Sizes bestSize = loadBest();
+                        if (pastExit(u, bestSize)) { break; }
+                        if (!Shard::owns(u)) { continue; }
+                        auto ego = extract(u, bestSize);
+                        if (!ego) { continue; }
+                        batchBytes += ego->bytes();
+                        batch.push_back(std::move(*ego));
+                        if (batchBytes >= PIPELINE_BATCH_BYTES) { flush(); }
+                    }
+                }
+                if (!batch.empty()) { flush(); }
+                activeExtractors.fetch_sub(1, std::memory_order_release);
+            } else {
+                std::vector<EgoNet<N>> batch;
+                while (true) {
+                    // everything was pushed before the last extractor finished
+                    bool finished = activeExtractors.load(std::memory_order_acquire) == 0;
+                    if (queue->tryPop(batch)) {
+                        int64_t batchBytes = 0;
+                        for (auto &ego : batch) {
+                            batchBytes += ego.bytes();
+                            solve(ego);
+                        }
+                        queuedBytes.fetch_sub(batchBytes);
+                        batch.clear();
+                    } else if (finished) {
+                        break;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+            if (pipelined) {
+#pragma omp barrier
+            }
+#pragma omp single
+            {
+                shareBound();
+                prune();
+                nextRoot = roundEnd;
+                activeExtractors = extractors;
+                stopped = exitRoot.load() < size;
+            }
+            if (stopped) { break; }
+        }
+        if (tracing) { trace().complete("ego_loop", loopStart, Trace::now()); }
+    }
+    if (pipelined) {
+        stats().set("pipeline_extractors", extractors);
+        stats().set("pipeline_queue_peak_bytes", queuedPeak.load());
+    }
+    stats().set("truss_edges_removed", trussRemoved);
+    // the roots of this shard the exit ruled out
+    int64_t skipped = 0;
+    for (v_id r = exitRoot.load(); r < size; r++) { skipped += Shard::owns(r); }
+    stats().set("ego_roots_skipped", skipped);
+    return solutions;
+}
+
+/// egoLoop with a single model
+template<class Model>
+std::vector<v_id> egoLoop(RankedGraph &ranked, const Model &model, bool twoHop,
+                          std::vector<v_id> initial) {
+    using Set = EgoModels<Model>;
+    return egoLoop(ranked, Set{{model}}, twoHop, typename Set::Solutions{std::move(initial)})[0];
+}
+
+} // namespace gm
+
+#endif // GM_EGOLOOP_HPP
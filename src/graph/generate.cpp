@@ -0,0 +1,172 @@
+#include "graph/generate.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/types.hpp"
+#include "util.hpp"
+
+namespace gm {
+
+using namespace std;
+
+namespace {
+
+using EdgeList = vector<pair<v_int, v_int>>;
+
+// Counter based random numbers: edge i always gets the same draws whichever thread makes it
+inline uint64_t splitmix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+inline uint64_t draw(uint64_t seed, uint64_t stream, uint64_t index) {
+    return splitmix(splitmix(seed ^ splitmix(stream)) + index);
+}
+// uniform in [0, bound)
+inline uint64_t below(uint64_t r, uint64_t bound) {
+    return uint64_t((unsigned __int128) r * bound >> 64);
+}
+inline double unit(uint64_t r) {
+    return (r >> 11) * 0x1.0p-53;
+}
+
+EdgeList erdosRenyi(const GenerateOptions &opts) {
+    EdgeList edges(opts.m);
+#pragma omp parallel for
+    for (int64_t i = 0; i < opts.m; i++) {
+        edges[i] = {v_int(below(draw(opts.seed, 0, i), opts.n)),
+                    v_int(below(draw(opts.seed, 1, i), opts.n))};
+    }
+    return edges;
+}
+
+EdgeList rmat(const GenerateOptions &opts) {
+    constexpr double a = 0.57, b = 0.19, c = 0.19;
+    int scale = std::max(1, int(ceil(log2(opts.n))));
+    EdgeList edges(opts.m);
+#pragma omp parallel for
+    for (int64_t i = 0; i < opts.m; i++) {
+        uint64_t u = 0, v = 0;
+        for (int level = 0; level < scale; level++) {
+            double r = unit(draw(opts.seed, level, i));
+            u <<= 1;
+            v <<= 1;
+            if (r < a) {
+            } else if (r < a + b) {
+                v |= 1;
+            } else if (r < a + b + c) {
+                u |= 1;
+            } else {
+                u |= 1;
+                v |= 1;
+            }
+        }
+        edges[i] = {v_int(u % opts.n), v_int(v % opts.n)};
+    }
+    return edges;
+}
+
+// Edge i starts at vertex i / d. Its other end is a uniformly random endpoint of the edges
+// before it, which is preferential attachment. Picking the target end of an earlier edge
+// recurses into that edge, so every edge can be resolved independently.
+EdgeList barabasiAlbert(const GenerateOptions &opts) {
+    int64_t d = std::max<int64_t>(1, opts.m / opts.n);
+    int64_t total = d * opts.n;
+    EdgeList edges(total);
+#pragma omp parallel for
+    for (int64_t i = 0; i < total; i++) {
+        int64_t j = i;
+        v_int target = 0;
+        while (j > 0) {
+            uint64_t r = below(draw(opts.seed, 0, j), 2 * j);
+            if (r % 2 == 0) {
+                target = (r / 2) / d;
+                break;
+            }
+            j = r / 2;
+        }
+        edges[i] = {v_int(i / d), target};
+    }
+    return edges;
+}
+
+// Plant a dense set on top of the edges. Starting from a clique, every round removes a
+// random perfect matching, so each vertex loses at most `rounds` edges.
+vector<v_id> plant(EdgeList &edges, const GenerateOptions &opts, v_int size, v_int rounds) {
+    mt19937_64 rng{splitmix(opts.seed ^ 0x706c616e74)};
+    size = std::min(size, opts.n);
+    set<v_id> chosen;
+    uniform_int_distribution<v_id> dist(0, opts.n - 1);
+    while (v_int(chosen.size()) < size) { chosen.insert(dist(rng)); }
+    vector<v_id> planted(chosen.begin(), chosen.end());
+
+    set<pair<v_id, v_id>> missing;
+    vector<v_id> order = planted;
+    for (v_int round = 0; round < rounds; round++) {
+        shuffle(order.begin(), order.end(), rng);
+        for (size_t i = 0; i + 1 < order.size(); i += 2) {
+            missing.insert(minmax(order[i], order[i + 1]));
+        }
+    }
+    for (size_t i = 0; i < planted.size(); i++) {
+        for (size_t j = i + 1; j < planted.size(); j++) {
+            if (!missing.count({planted[i], planted[j]})) { edges.emplace_back(planted[i], planted[j]); }
+        }
+    }
+    return planted;
+}
+
+} // namespace
+
+GeneratedGraph generateGraph(const GenerateOptions &opts) {
+    GM_ASSERT(opts.n > 0, "generateGraph: n should be >0");
+    EdgeList edges;
+    vector<v_id> planted;
+    v_int plantedSize = opts.plantedSize > 0 ? opts.plantedSize
+                                             : std::max<v_int>(10, 4 * opts.m / opts.n);
+    if (opts.model == "er") {
+        edges = erdosRenyi(opts);
+    } else if (opts.model == "rmat") {
+        edges = rmat(opts);
+    } else if (opts.model == "ba") {
+        edges = barabasiAlbert(opts);
+    } else if (opts.model == "kplex") {
+        edges = erdosRenyi(opts);
+        // each vertex is non-adjacent to at most k - 1 others
+        planted = plant(edges, opts, plantedSize, opts.k - 1);
+    } else if (opts.model == "quasi") {
+        edges = erdosRenyi(opts);
+        // each vertex keeps at least ceil(alpha * (size - 1)) neighbours
+        v_int size = std::min(plantedSize, opts.n);
+        v_int rounds = (size - 1) - v_int(ceil(opts.alpha * (size - 1)));
+        planted = plant(edges, opts, size, std::max<v_int>(rounds, 0));
+    } else {
+        GM_ASSERT(false, "generateGraph: unknown model " + opts.model);
+    }
+    return {v2::Graph::fromEdges(opts.n, edges), std::move(planted)};
+}
+
+void generateToFile(const GenerateOptions &opts, const std::string &outputPath) {
+    GeneratedGraph generated = generateGraph(opts);
+    cout << format("[generate] model={} seed={} ", opts.model, opts.seed) << generated.graph << "\n";
+    v2::writeGraphBinary(generated.graph, outputPath);
+    if (!generated.planted.empty()) {
+        ofstream out{outputPath + "/planted.txt"};
+        for (v_id v : generated.planted) { out << v << "\n"; }
+        cout << format("[generate] planted {} vertices, see {}/planted.txt\n",
+                       generated.planted.size(), outputPath);
+    }
+}
+
+} // namespace gm
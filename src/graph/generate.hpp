@@ -0,0 +1,50 @@
+#ifndef GM_GENERATE_HPP
+#define GM_GENERATE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/types.hpp"
+
+namespace gm {
+
+struct GenerateOptions {
+    // er, rmat, ba, kplex or quasi
+    std::string model = "er";
+    v_int n = 1000;
+    // number of edges to draw, duplicates and self-loops are dropped afterwards
+    int64_t m = 8000;
+    uint64_t seed = 1;
+    // k of the planted k-plex
+    v_int k = 2;
+    // alpha of the planted quasi-clique
+    double alpha = 0.9;
+    // size of the planted k-plex / quasi-clique, 0 to derive it from the density
+    v_int plantedSize = 0;
+};
+
+struct GeneratedGraph {
+    v2::Graph graph;
+    // vertices of the planted k-plex / quasi-clique, empty for the other models
+    std::vector<v_id> planted;
+};
+
+/// Generate a synthetic graph. The output only depends on the options, not on the number
+/// of threads.
+///
+///   er     Erdos-Renyi G(n, m)
+///   rmat   R-MAT / Kronecker with (a, b, c, d) = (0.57, 0.19, 0.19, 0.05)
+///   ba     Barabasi-Albert, m / n edges per vertex
+///   kplex  Erdos-Renyi background with a planted k-plex
+///   quasi  Erdos-Renyi background with a planted alpha-quasi-clique
+GeneratedGraph generateGraph(const GenerateOptions &opts);
+
+/// Generate a graph and write it in the binary format (b_degree.bin and b_adj.bin) to the
+/// directory at outputPath, plus planted.txt with the planted vertices if there are any.
+void generateToFile(const GenerateOptions &opts, const std::string &outputPath);
+
+} // namespace gm
+
+#endif // GM_GENERATE_HPP
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <chrono>
 #include <cstdio>
 #include <cstring>
@@ -9,13 +10,21 @@
 #include <format>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <numeric>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "alloc.hpp"
+#include "graph/intersect.hpp"
+#include "graph/relabel.hpp"
+#include "graph/stream.hpp"
 #include "graph/types.hpp"
 #include "heap.hpp"
+#include "scratch.hpp"
+#include "perf.hpp"
+#include "stats.hpp"
 
 using namespace std;
 
@@ -23,20 +32,6 @@ namespace gm::v2 {
 
 namespace fs = std::filesystem;
 
-GraphV2::GraphV2(v_int n, v_int m) : n(n), m(m), off(new v_int[n + 1]), e(new v_int[2 * m]) {
-    off[n] = 2 * m;
-}
-GraphV2::GraphV2(GraphV2 &&other) {
-    e = other.e;
-    off = other.off;
-    other.e = other.off = nullptr;
-}
-
-GraphV2::~GraphV2() {
-    delete[] e;
-    delete[] off;
-}
-
 GraphV2 readGraphBinary(std::string path) {
     std::cout << "[readGraphBinary] reading using b_degree.bin and b_adj.bin files\n";
     std::string degreesPath = path + "/b_degree.bin";
@@ -52,10 +47,9 @@ GraphV2 readGraphBinary(std::string path) {
     GM_ASSERT(ret == 2, ("readGraphBinary"));
 
     v_int n = nm[0], m = nm[1];
-    v_int *degrees = new v_int[n + 1];
-    v_int *edges = new v_int[m];
+    v_int *degrees = allocArray<v_int>(n + 1);
+    v_int *edges = allocArray<v_int>(m);
 
-    std::vector<v_int> adjs(m, 0);
     ret = fread(degrees, sizeof(degrees[0]), n, fp);
     GM_ASSERT(ret == n, ("readGraphBinary"));
     fclose(fp);
@@ -93,59 +87,221 @@ GraphV2 readGraphBinary(std::string path) {
     return g;
 }
 
-GraphV2 GraphV2::readFromFile(std::string path) {
+// SNAP edge list: "# ..." comment lines, then one "u v" line per edge, maybe with more columns.
+// Vertex ids may be sparse, so they are compacted.
+static GraphV2 readSnap(InputStream &in, const std::string &path, std::vector<int64_t> *labels) {
+    in.comment = '#';
+    std::vector<std::pair<int64_t, int64_t>> edges;
+    for (int64_t u, v; in.nextInt(u);) {
+        GM_ASSERT(in.nextInt(v), "readFromFile: odd number of vertex ids in " + path);
+        edges.emplace_back(u, v);
+        in.skipLine();
+    }
+    TrackedBytes loadBuffer{Memory::LoadBuffer, int64_t(edges.capacity() * sizeof(edges[0]))};
+    std::vector<int64_t> compacted;
+    std::vector<std::pair<v_int, v_int>> dense = compactIds(edges, compacted);
+    cerr << format("[Graph::readFromFile] SNAP edge list, {} vertex ids up to {}\n",
+                   compacted.size(), compacted.empty() ? 0 : compacted.back());
+    GraphV2 g = GraphV2::fromEdges(compacted.size(), dense);
+    if (labels) { *labels = std::move(compacted); }
+    return g;
+}
+
+// Matrix Market coordinate file of a square matrix: a "%%MatrixMarket matrix coordinate <field>
+// <symmetry>" line, "%" comment lines, "rows cols entries", then one "i j [value]" line per
+// entry with 1-based indices. Entry (i, j) is an edge whatever the symmetry says.
+static GraphV2 readMatrixMarket(InputStream &in, const std::string &path,
+                                std::vector<int64_t> *labels) {
+    std::string banner;
+    in.nextLine(banner);
+    std::transform(banner.begin(), banner.end(), banner.begin(), ::tolower);
+    GM_ASSERT(banner.find(" coordinate") != std::string::npos,
+              "readFromFile: only coordinate Matrix Market files are supported, not " + path);
+    in.comment = '%';
+    int64_t rows, cols, entries;
+    GM_ASSERT(in.nextInt(rows) && in.nextInt(cols) && in.nextInt(entries),
+              "readFromFile: no size line in " + path);
+    GM_ASSERT(rows == cols, "readFromFile: the matrix in " + path + " is not square");
+    in.skipLine();
+
+    std::vector<std::pair<v_int, v_int>> edges;
+    edges.reserve(entries);
+    TrackedBytes loadBuffer{Memory::LoadBuffer, int64_t(edges.capacity() * sizeof(edges[0]))};
+    for (int64_t i = 0; i < entries; i++) {
+        int64_t u, v;
+        GM_ASSERT(in.nextInt(u) && in.nextInt(v),
+                  "readFromFile: fewer entries than its size line says in " + path);
+        GM_ASSERT(1 <= u && u <= rows && 1 <= v && v <= rows,
+                  "readFromFile: index out of range in " + path);
+        edges.emplace_back(u - 1, v - 1);
+        in.skipLine();
+    }
+    if (labels) {
+        labels->resize(rows);
+        std::iota(labels->begin(), labels->end(), 1);
+    }
+    return GraphV2::fromEdges(rows, edges);
+}
+
+void writeGraphBinary(GraphV2 &g, std::string path) {
+    fs::create_directories(path);
+    std::string degreesPath = path + "/b_degree.bin";
+    std::string edgesPath = path + "/b_adj.bin";
+    FILE *fp = fopen(degreesPath.c_str(), "wb");
+    GM_ASSERT(fp, ("writeGraphBinary: cannot open " + degreesPath));
+    v_int tt = sizeof(v_int);
+    v_int nm[2] = {g.size(), g.eSize()};
+    fwrite(&tt, sizeof(tt), 1, fp);
+    fwrite(nm, sizeof(nm[0]), 2, fp);
+    for (v_int i = 0; i < g.size(); i++) {
+        v_int degree = g.degree(i);
+        fwrite(&degree, sizeof(degree), 1, fp);
+    }
+    fclose(fp);
+
+    FILE *fpEdges = fopen(edgesPath.c_str(), "wb");
+    GM_ASSERT(fpEdges, ("writeGraphBinary: cannot open " + edgesPath));
+    size_t ret = fwrite(g.e, sizeof(g.e[0]), g.eSize(), fpEdges);
+    GM_ASSERT(ret == size_t(g.eSize()), ("writeGraphBinary"));
+    fclose(fpEdges);
+}
+
+template<>
+GraphV2 GraphV2::readFromFile(std::string path, std::vector<int64_t> *labels) {
+    PhaseTimer timer{Phase::Load};
+    PerfScope perfScope{PerfPhase::Load};
+    if (labels) { labels->clear(); }
     if (fs::is_directory(path)) { return readGraphBinary(path); }
     cerr << format("[Graph::readFromFile] reading from {}\n", path);
-    std::ifstream ifs{path, std::ifstream::in};
+    InputStream in{path};
+    if (in.peek() == '%') { return readMatrixMarket(in, path, labels); }
+    if (in.peek() == '#') { return readSnap(in, path, labels); }
 
-    v_int n, m;
-    ifs >> n >> m;
+    int64_t n, m;
+    GM_ASSERT(in.nextInt(n) && in.nextInt(m), "readFromFile: no header in " + path);
 
-    GraphV2 g{n, m};
+    GraphV2 g{v_int(n), v_int(m)};
     std::vector<std::pair<v_int, v_int>> edges;
+    edges.reserve(m);
+    TrackedBytes loadBuffer{Memory::LoadBuffer, int64_t(edges.capacity() * sizeof(edges[0]))};
 
     for (v_int i = 0; i < m; i++) {
-        v_id u, v;
-        ifs >> u >> v;
+        int64_t u, v;
+        GM_ASSERT(in.nextInt(u) && in.nextInt(v), "readFromFile: fewer than m edges in " + path);
         edges.push_back(make_pair(u, v));
-        edges.push_back(make_pair(v, u));
     }
-    std::sort(edges.begin(), edges.end());
 
-    // Init offset to -1
-    memset(g.off, -1, sizeof(v_int) * n);
-
-    for (auto i = 0; i < edges.size(); i++) {
-        int u = edges[i].first;
-        int v = edges[i].second;
-        if (g.off[u] == -1) { g.off[u] = i; }
-        g.e[i] = v;
+    // Bucket both directions of every edge by source, then sort each list: the same CSR as
+    // sorting all (u, v) pairs, in linear time plus the sorts of the (short) lists. Self-loops
+    // and repeated edges are dropped, as in fromEdges.
+    memset(g.off, 0, sizeof(v_int) * (n + 1));
+    for (auto [u, v] : edges) {
+        g.off[u + 1]++;
+        g.off[v + 1]++;
     }
-    for (auto i = 0; i < g.size(); i++) {
-        if (g.off[i] == -1) { g.off[i] = (i == 0 ? 0 : g.off[i - 1]); }
+    for (v_int i = 0; i < n; i++) { g.off[i + 1] += g.off[i]; }
+    std::vector<v_int> fill(g.off, g.off + n);
+    for (auto [u, v] : edges) {
+        g.e[fill[u]++] = v;
+        g.e[fill[v]++] = u;
     }
-    g.off[g.size()] = g.eSize();
+    std::vector<v_int> degrees(n);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (v_int u = 0; u < g.size(); u++) {
+        std::sort(g.edges(u), g.edgesEnd(u));
+        v_int *end = std::unique(g.edges(u), g.edgesEnd(u));
+        end = std::remove(g.edges(u), end, u);
+        degrees[u] = end - g.edges(u);
+    }
+    // move the lists down over the dropped ids
+    v_int kept = 0;
+    for (v_int u = 0; u < n; u++) {
+        v_int *begin = g.edges(u);
+        g.off[u] = kept;
+        std::copy(begin, begin + degrees[u], g.e + kept);
+        kept += degrees[u];
+    }
+    g.off[n] = kept;
+    g.m = kept / 2;
     return g;
 }
 
+template<class Id, class Offset>
+BasicGraph<Id, Offset> BasicGraph<Id, Offset>::fromEdges(v_int n,
+                                                         const vector<pair<v_int, v_int>> &edges) {
+    // count, then scatter both directions of every edge
+    std::vector<int64_t> counts(n + 1, 0);
+#pragma omp parallel for
+    for (size_t i = 0; i < edges.size(); i++) {
+        auto [u, v] = edges[i];
+#pragma omp atomic
+        counts[u + 1]++;
+#pragma omp atomic
+        counts[v + 1]++;
+    }
+    for (v_int i = 0; i < n; i++) { counts[i + 1] += counts[i]; }
+    std::vector<int64_t> fill(counts.begin(), counts.end() - 1);
+    std::vector<v_int> adj(counts[n]);
+#pragma omp parallel for
+    for (size_t i = 0; i < edges.size(); i++) {
+        auto [u, v] = edges[i];
+        int64_t pu, pv;
+#pragma omp atomic capture
+        pu = fill[u]++;
+#pragma omp atomic capture
+        pv = fill[v]++;
+        adj[pu] = v;
+        adj[pv] = u;
+    }
+
+    // sort each list, drop self-loops and duplicates
+    std::vector<v_int> degrees(n);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (v_int u = 0; u < n; u++) {
+        v_int *begin = adj.data() + counts[u], *end = adj.data() + counts[u + 1];
+        std::sort(begin, end);
+        v_int *dest = begin;
+        for (v_int *v = begin; v != end; v++) {
+            if (*v != u && (v == begin || *v != *(v - 1))) { *dest++ = *v; }
+        }
+        degrees[u] = dest - begin;
+    }
+
+    Offset *off = allocArray<Offset>(n + 1);
+    off[0] = 0;
+    for (v_int u = 0; u < n; u++) { off[u + 1] = off[u] + degrees[u]; }
+    Id *e = allocArray<Id>(off[n]);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (v_int u = 0; u < n; u++) {
+        std::copy(adj.begin() + counts[u], adj.begin() + counts[u] + degrees[u], e + off[u]);
+    }
+    return BasicGraph{n, v_int(off[n] / 2), off, e};
+}
+
+template GraphV2 GraphV2::fromEdges(v_int n, const vector<pair<v_int, v_int>> &edges);
+template SmallGraph SmallGraph::fromEdges(v_int n, const vector<pair<v_int, v_int>> &edges);
+
+template<>
 GraphV2
 GraphV2::subgraph(const std::vector<v_int> &vertices, std::vector<v_int> *vMapOut /* = nullptr */) {
     // Map from old vertex id -> new vertex id
-    static vector<v_int> vMap(this->size(), -1); // optimize
+    EpochMap<v_int> &vMap = gm::scratch().position;
+    vMap.resize(this->size());
+    vMap.clear();
     // std::sort(vertices.begin(), vertices.end());
     v_int nextId = 0;
     for (v_int v : vertices) {
-        vMap[v] = nextId;
+        vMap.set(v, nextId);
         nextId++;
     }
-    static std::vector<pair<v_int, v_int>> edges;
+    static thread_local std::vector<pair<v_int, v_int>> edges;
     edges.clear();
     for (v_int u : vertices) {
         for (v_int v : this->iterNeighbours(u)) {
-            if (vMap[v] >= 0) {
+            if (v_int w = vMap.get(v, -1); w >= 0) {
                 // reverse will also be pushed
                 // we guarantee all edges starting with u is consecutive
-                edges.push_back(make_pair(vMap[u], vMap[v]));
+                edges.push_back(make_pair(vMap.get(u, -1), w));
             }
         }
     }
@@ -169,62 +325,145 @@ GraphV2::subgraph(const std::vector<v_int> &vertices, std::vector<v_int> *vMapOu
     g.off[g.size()] = g.eSize();
 
     // if (vMapOut) { *vMapOut = std::move(vMap); }
-    for (v_int u : vertices) { vMap[u] = -1; }
 
     return g;
 }
 
-std::ostream &operator<<(std::ostream &os, const GraphV2 &graph) {
-    return os << "Graph{size=" << graph.size() << ",edges=" << graph.nEdges() << "}";
+template<>
+void GraphV2::buildHubs(v_int minDegree) {
+    hubs = std::make_unique<HubRows>(n, off, e, minDegree);
+}
+
+template<>
+size_t GraphV2::adjacentCount(v_int u, const v_int *sorted, size_t count) {
+    // mostly bit tests, where intersecting is linear in both lists or galloping in the row
+    if (isHub(u) && hubs->dense(u)) { return hubs->countIn(u, sorted, sorted + count); }
+    return intersectCount(edges(u), degree(u), sorted, count);
 }
 
-std::vector<v_id> degenOrdering(GraphV2 &g) {
+template<>
+size_t GraphV2::commonNeighbours(v_int u, v_int v) {
+    bool denseU = isHub(u) && hubs->dense(u), denseV = isHub(v) && hubs->dense(v);
+    if (!denseU && !denseV) { return intersectCount(edges(u), degree(u), edges(v), degree(v)); }
+    if (isHub(u) && isHub(v)) { return hubs->commonCount(u, v); }
+    if (denseV) { std::swap(u, v); }
+    return hubs->countIn(u, edges(v), edgesEnd(v));
+}
+
+template<class G>
+std::vector<v_id> degenOrdering(G &g) {
+    using Id = typename G::Id;
     vector<v_id> result;
-    vector<v_id> degrees;
+    vector<Id> degrees;
     result.reserve(g.size());
     degrees.reserve(g.size());
 
     for (v_id i = 0; i < g.size(); i++) { degrees.push_back(g.degree(i)); }
 
-    GraphLinearHeap heap(g.size(), g.size() + 1, degrees);
+    BucketHeap<Id, Id> heap(degrees);
     for (v_id i = 0; i < g.size(); i++) {
         auto smallestDeg = heap.popMin();
         v_id u = smallestDeg.first;
-        for (v_id *vp = g.edges(u); vp != g.edgesEnd(u); vp++) { heap.decrement(*vp, 1); }
+        heap.decrementBatch(g.edges(u), g.edgesEnd(u));
         result.push_back(u);
     }
     return result;
 }
 
+template std::vector<v_id> degenOrdering(GraphV2 &g);
+template std::vector<v_id> degenOrdering(SmallGraph &g);
+
 // Generate subgraph, using degenRank optimisation
-GraphV2 subgraphDegen(GraphV2 &g, std::vector<v_int> &vertices, v_int *degenRank) {
-    // Map from old vertex id -> new vertex id
-    static vector<v_int> vMap(g.size(), -1);
+template<class Sub>
+Sub subgraphDegen(GraphV2 &g, const std::vector<v_int> &vertices) {
+    // Map from old vertex id -> new vertex id, for small subgraphs
+    EpochMap<v_int> &vMap = gm::scratch().position;
+    // candidates sorted by id, with their new id, for large subgraphs
+    static thread_local vector<pair<v_int, v_int>> sorted;
+    static thread_local vector<v_int> keys, newId, position, matches;
+    static thread_local std::vector<pair<v_int, v_int>> edges;
+    auto scratchSize = [&] {
+        return int64_t(sorted.capacity() * sizeof(sorted[0]) + edges.capacity() * sizeof(edges[0]) +
+                       (keys.capacity() + newId.capacity() + position.capacity() +
+                        matches.capacity()) *
+                           sizeof(v_int)) +
+               vMap.bytes();
+    };
+    int64_t scratchBytes = scratchSize();
     v_int size = vertices.size();
-    // std::sort(vertices.begin(), vertices.end());
-    v_int nextId = 0;
-    for (v_int v : vertices) {
-        vMap[v] = nextId;
-        nextId++;
-    }
-    static std::vector<pair<v_int, v_int>> edges;
     edges.clear();
-    v_int *degrees = new v_int[size]{0};
-    v_int *offsets = new v_int[size + 1]{0};
-
-    for (v_int u : vertices) {
-        for (v_int v : g.iterNeighbours(u)) {
-            if (degenRank[v] < degenRank[u]) { break; }
-            if (vMap[v] >= 0) {
-                // reverse will also be pushed
-                edges.push_back(make_pair(vMap[u], vMap[v]));
-                edges.push_back(make_pair(vMap[v], vMap[u]));
-                degrees[vMap[u]]++;
-                degrees[vMap[v]]++;
+    vector<v_int> degrees(size, 0);
+    using Id = typename Sub::Id;
+    using Offset = typename Sub::Offset;
+    Offset *offsets = allocArray<Offset>(size + 1);
+    offsets[0] = 0;
+    auto addEdge = [&](v_int u, v_int v) {
+        // reverse will also be pushed
+        edges.push_back(make_pair(u, v));
+        edges.push_back(make_pair(v, u));
+        degrees[u]++;
+        degrees[v]++;
+    };
+
+    if (size < INTERSECT_MIN_SIZE) {
+        // probe every neighbour earlier in the ranked order
+        vMap.resize(g.size());
+        vMap.clear();
+        for (v_int i = 0; i < size; i++) { vMap.set(vertices[i], i); }
+        for (v_int i = 0; i < size; i++) {
+            v_int u = vertices[i];
+            int64_t prefix =
+                g.isHub(u) ? std::lower_bound(g.edges(u), g.edgesEnd(u), u) - g.edges(u) : 0;
+            if (prefix > HubRows::PROBE_COST * size) {
+                // probing the candidates in the row is cheaper than scanning the prefix, sort
+                // what it finds to keep the order of the scan
+                sorted.clear();
+                for (v_int j = 0; j < size; j++) {
+                    if (vertices[j] < u && g.hubs->contains(u, vertices[j])) {
+                        sorted.emplace_back(vertices[j], j);
+                    }
+                }
+                std::sort(sorted.begin(), sorted.end());
+                for (auto [v, j] : sorted) { addEdge(i, j); }
+                continue;
+            }
+            for (v_int v : g.iterNeighbours(u)) {
+                if (v > u) { break; }
+                if (v_int j = vMap.get(v, -1); j >= 0) { addEdge(i, j); }
             }
         }
+    } else {
+        // intersect the same prefix with the candidates before u, which finds the same
+        // neighbours in the same order without touching an array of size n
+        sorted.clear();
+        for (v_int i = 0; i < size; i++) { sorted.emplace_back(vertices[i], i); }
+        std::sort(sorted.begin(), sorted.end());
+        keys.resize(size);
+        newId.resize(size);
+        position.resize(size);
+        matches.resize(size);
+        for (v_int p = 0; p < size; p++) {
+            keys[p] = sorted[p].first;
+            newId[p] = sorted[p].second;
+            position[sorted[p].second] = p;
+        }
+        for (v_int i = 0; i < size; i++) {
+            v_int u = vertices[i];
+            v_int *prefixEnd = std::lower_bound(g.edges(u), g.edgesEnd(u), u);
+            size_t found = 0;
+            if (g.isHub(u) && prefixEnd - g.edges(u) > HubRows::PROBE_COST * position[i]) {
+                // probe the candidates before u in the row instead
+                for (v_int p = 0; p < position[i]; p++) {
+                    if (g.hubs->contains(u, keys[p])) { matches[found++] = p; }
+                }
+            } else {
+                found = intersectIndices(keys.data(), position[i], g.edges(u),
+                                         prefixEnd - g.edges(u), matches.data());
+            }
+            for (size_t k = 0; k < found; k++) { addEdge(i, newId[matches[k]]); }
+        }
     }
-    v_int *adj = new v_int[edges.size()];
+    Id *adj = allocArray<Id>(edges.size());
 
     for (v_int i = 0; i < size; i++) { offsets[i + 1] = offsets[i] + degrees[i]; }
     for (const auto &e : edges) {
@@ -235,12 +474,14 @@ GraphV2 subgraphDegen(GraphV2 &g, std::vector<v_int> &vertices, v_int *degenRank
     offsets[0] = 0;
     for (v_int i = 0; i < size; i++) { offsets[i + 1] = offsets[i] + degrees[i]; }
 
-    GraphV2 sub{size, (v_int) edges.size(), offsets, adj};
-    // if (vMapOut) { *vMapOut = std::move(vMap); }
-    for (auto u : vertices) { vMap[u] = -1; }
+    Sub sub{size, v_int(edges.size() / 2), offsets, adj};
+    // the buffers only grow, count the growth
+    stats().memory(Memory::SubgraphScratch, scratchSize() - scratchBytes);
 
     return sub;
 }
 
+template GraphV2 subgraphDegen(GraphV2 &g, const std::vector<v_int> &vertices);
+template SmallGraph subgraphDegen(GraphV2 &g, const std::vector<v_int> &vertices);
 
 } // namespace gm::v2
@@ -1,14 +1,23 @@
 #ifndef GM_GRAPHV2_HPP
 #define GM_GRAPHV2_HPP
 
+#include "alloc.hpp"
+#include "graph/hubs.hpp"
 #include "graph/types.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace gm::v2 {
 
 class Subgraph;
 
+template<class Id = v_int>
 class NeighboursRange {
 public:
     inline auto begin() {
@@ -18,24 +27,64 @@ public:
         return end_;
     }
 
-    NeighboursRange(v_int *begin, v_int *end) : begin_(begin), end_(end) {}
+    NeighboursRange(Id *begin, Id *end) : begin_(begin), end_(end) {}
 
 private:
-    v_int *begin_;
-    v_int *end_;
+    Id *begin_;
+    Id *end_;
 };
 
-/// A more efficient graph implementation.
-class GraphV2 {
+/// A more efficient graph implementation. Vertex ids in the adjacency array are IdT and
+/// positions in it OffsetT, so ego subgraphs can use 16-bit ids (see SmallGraph).
+template<class IdT, class OffsetT>
+class BasicGraph {
 public:
-    GraphV2(v_int n, v_int m);
+    using Id = IdT;
+    using Offset = OffsetT;
+
+    BasicGraph(v_int n, v_int m)
+        : n(n), m(m), off(allocArray<Offset>(n + 1)), e(allocArray<Id>(2 * size_t(m))) {
+        off[n] = 2 * m;
+    }
     // for reading from binary file
-    inline GraphV2(v_int n, v_int m, v_int *off, v_int *e) : n(n), m(m), off(off), e(e) {}
-    GraphV2(const GraphV2 &) = delete;
-    GraphV2 &operator=(const GraphV2 &) = delete;
-    GraphV2(GraphV2 &&other);
-    ~GraphV2();
-    static GraphV2 readFromFile(std::string path);
+    inline BasicGraph(v_int n, v_int m, Offset *off, Id *e) : n(n), m(m), off(off), e(e) {}
+    BasicGraph(const BasicGraph &) = delete;
+    BasicGraph &operator=(const BasicGraph &) = delete;
+    BasicGraph(BasicGraph &&other) noexcept
+        : n(other.n), m(other.m), off(other.off), e(other.e), hubs(std::move(other.hubs)) {
+        other.e = nullptr;
+        other.off = nullptr;
+    }
+    BasicGraph &operator=(BasicGraph &&other) noexcept {
+        if (this != &other) {
+            freeArray(e);
+            freeArray(off);
+            n = other.n;
+            m = other.m;
+            off = other.off;
+            e = other.e;
+            hubs = std::move(other.hubs);
+            other.e = nullptr;
+            other.off = nullptr;
+        }
+        return *this;
+    }
+    ~BasicGraph() {
+        freeArray(e);
+        freeArray(off);
+    }
+    /// Read a binary graph directory (see writeGraphBinary) or a text file, maybe compressed
+    /// (see InputStream). Text files are told apart by their first character:
+    ///   '%'        Matrix Market coordinate file, vertex i is row i + 1
+    ///   '#'        SNAP edge list, vertex ids compacted to 0..n-1 in ascending order
+    ///   otherwise  "n m" then m lines "u v" of 0-based ids
+    /// Matrix Market and SNAP files may have self-loops, both directions and duplicates of an
+    /// edge, which are dropped. If labels isn't null it gets the id in the file of every vertex,
+    /// or is left empty if the ids are the same.
+    static BasicGraph readFromFile(std::string path, std::vector<int64_t> *labels = nullptr);
+    /// Build from undirected edges, each listed once. Self-loops and duplicates are dropped
+    /// and adjacency lists are sorted by id. Runs in parallel with OpenMP.
+    static BasicGraph fromEdges(v_int n, const std::vector<std::pair<v_int, v_int>> &edges);
 
     inline v_int size() const {
         return n;
@@ -43,26 +92,46 @@ public:
     inline v_int nEdges() const {
         return m;
     }
-    inline NeighboursRange iterNeighbours(v_int u) {
-        return NeighboursRange{edges(u), edgesEnd(u)};
+    inline NeighboursRange<Id> iterNeighbours(v_int u) {
+        return NeighboursRange<Id>{edges(u), edgesEnd(u)};
     }
-    inline v_int *edges(v_int u) {
+    inline Id *edges(v_int u) {
         return e + off[u];
     }
-    inline v_int *edgesEnd(v_int u) {
+    inline Id *edgesEnd(v_int u) {
         return e + off[u + 1];
     }
     inline v_int degree(v_int u) {
         return off[u + 1] - off[u];
     }
-    GraphV2 subgraph(const std::vector<v_int> &vertices, std::vector<v_int> *vMapOut = nullptr);
-    friend std::ostream &operator<<(std::ostream &os, const GraphV2 &g);
-    friend Subgraph subgraphDegen(GraphV2 &g, const std::vector<v_int> &vertices);
+    /// Bytes of the offset and adjacency arrays
+    inline int64_t bytes() const {
+        return (int64_t(n) + 1) * sizeof(Offset) + 2 * int64_t(m) * sizeof(Id);
+    }
+    BasicGraph subgraph(const std::vector<v_int> &vertices, std::vector<v_int> *vMapOut = nullptr);
+
+    /// (Re)build the bitmap rows of the vertices of degree at least minDegree
+    void buildHubs(v_int minDegree);
+    bool isHub(v_int u) const {
+        return hubs && hubs->isHub(u);
+    }
+    /// A bit test if u or v is a hub, a binary search in the shorter list otherwise
+    bool hasEdge(v_int u, v_int v) {
+        if (isHub(u)) { return hubs->contains(u, v); }
+        if (isHub(v)) { return hubs->contains(v, u); }
+        if (degree(u) > degree(v)) { std::swap(u, v); }
+        return std::binary_search(edges(u), edgesEnd(u), Id(v));
+    }
+    /// Number of neighbours of u among the ascending ids in [sorted, sorted + count)
+    size_t adjacentCount(v_int u, const v_int *sorted, size_t count);
+    /// Number of common neighbours of u and v
+    size_t commonNeighbours(v_int u, v_int v);
 
     // private:
     v_int n, m;
-    v_int *off;
-    v_int *e;
+    Offset *off;
+    Id *e;
+    std::unique_ptr<HubRows> hubs; // null unless buildHubs was called
     inline v_int eSize() {
         return 2 * m;
     }
@@ -70,10 +139,36 @@ public:
         return n;
     }
 };
-using Graph = GraphV2;
 
-std::vector<v_id> degenOrdering(GraphV2 &g);
-// Subgraph subgraphDegen(GraphV2 &g, const std::vector<v_int> &vertices);
+template<class Id, class Offset>
+std::ostream &operator<<(std::ostream &os, const BasicGraph<Id, Offset> &graph) {
+    return os << "Graph{size=" << graph.size() << ",edges=" << graph.nEdges() << "}";
+}
+
+using GraphV2 = BasicGraph<v_int, v_int>;
+using Graph = GraphV2;
+/// Ego subgraphs with up to SMALL_GRAPH_MAX vertices, at half the bytes per neighbour
+using SmallGraph = BasicGraph<uint16_t, v_int>;
+inline constexpr v_int SMALL_GRAPH_MAX = std::numeric_limits<uint16_t>::max();
+
+// only for the full width graph
+template<>
+GraphV2 GraphV2::readFromFile(std::string path, std::vector<int64_t> *labels);
+template<>
+GraphV2 GraphV2::subgraph(const std::vector<v_int> &vertices, std::vector<v_int> *vMapOut);
+template<>
+void GraphV2::buildHubs(v_int minDegree);
+template<>
+size_t GraphV2::adjacentCount(v_int u, const v_int *sorted, size_t count);
+template<>
+size_t GraphV2::commonNeighbours(v_int u, v_int v);
+
+/// Vertices in the order repeatedly removing one of minimum degree takes them
+template<class G>
+std::vector<v_id> degenOrdering(G &g);
+/// Write g as a directory with b_degree.bin and b_adj.bin, the format readFromFile
+/// reads for directories.
+void writeGraphBinary(GraphV2 &g, std::string path);
 
 // not used
 class Subgraph {
@@ -96,8 +191,8 @@ public:
     inline v_int degree(v_int u) {
         return deg[u];
     }
-    inline NeighboursRange iterNeighbours(v_int u) {
-        return NeighboursRange{edges(u), edgesEnd(u)};
+    inline NeighboursRange<> iterNeighbours(v_int u) {
+        return NeighboursRange<>{edges(u), edgesEnd(u)};
     }
 
     v_int n;
@@ -107,7 +202,15 @@ public:
     v_int *deg; // degree of each vertex
 };
 
-GraphV2 subgraphDegen(GraphV2 &g, std::vector<v_int> &vertices, v_int *degenRank);
+/// Subgraphs with at least this many vertices are built with sorted list intersections
+/// instead of a lookup table of size n
+inline v_int INTERSECT_MIN_SIZE = 128;
+
+/// Subgraph induced by vertices, vertex i of the result is vertices[i]. g has to be ranked
+/// (see rankGraph): each edge is found once, from its endpoint later in the ranked order.
+/// Sub is GraphV2 or, for at most SMALL_GRAPH_MAX vertices, SmallGraph.
+template<class Sub = GraphV2>
+Sub subgraphDegen(GraphV2 &g, const std::vector<v_int> &vertices);
 
 } // namespace gm::v2
 
@@ -0,0 +1,111 @@
+#include "graph/hubs.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "graph/types.hpp"
+#include "stats.hpp"
+
+namespace gm {
+
+using namespace std;
+
+HubRows::HubRows(v_int n, const v_int *off, const v_int *e, v_int minDegree)
+    : threshold_(minDegree), index(n, -1) {
+    vector<v_int> hubs;
+    for (v_int u = 0; u < n; u++) {
+        if (off[u + 1] - off[u] >= minDegree) {
+            index[u] = hubs.size();
+            hubs.push_back(u);
+        }
+    }
+    rows.resize(hubs.size());
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t r = 0; r < hubs.size(); r++) {
+        Row &row = rows[r];
+        const v_int *begin = e + off[hubs[r]], *end = e + off[hubs[r] + 1];
+        while (begin != end) {
+            // the neighbours in the same 2^16 ids as *begin
+            v_int chunk = *begin >> 16;
+            const v_int *chunkEnd = begin;
+            while (chunkEnd != end && (*chunkEnd >> 16) == chunk) { ++chunkEnd; }
+            uint32_t size = chunkEnd - begin;
+            row.keys.push_back(chunk);
+            row.ids += size;
+            if (size > ARRAY_MAX) {
+                row.denseIds += size;
+                row.containers.push_back({uint32_t(row.bitmaps.size()), size});
+                size_t first = row.bitmaps.size();
+                row.bitmaps.resize(first + (1 << 16) / 64, 0);
+                for (const v_int *v = begin; v != chunkEnd; ++v) {
+                    uint16_t low = *v & 0xffff;
+                    row.bitmaps[first + (low >> 6)] |= uint64_t(1) << (low & 63);
+                }
+            } else {
+                row.containers.push_back({uint32_t(row.arrays.size()), size});
+                for (const v_int *v = begin; v != chunkEnd; ++v) {
+                    row.arrays.push_back(*v & 0xffff);
+                }
+            }
+            begin = chunkEnd;
+        }
+    }
+
+    int64_t total = index.capacity() * sizeof(int32_t) + rows.capacity() * sizeof(Row);
+    for (const Row &row : rows) {
+        total += row.keys.capacity() * sizeof(uint16_t) +
+                 row.containers.capacity() * sizeof(Container) +
+                 row.arrays.capacity() * sizeof(uint16_t) +
+                 row.bitmaps.capacity() * sizeof(uint64_t);
+    }
+    bytes.update(total);
+}
+
+size_t HubRows::commonCount(v_int u, v_int v) const {
+    const Row &a = rows[index[u]], &b = rows[index[v]];
+    size_t count = 0;
+    for (size_t ka = 0, kb = 0; ka < a.keys.size() && kb < b.keys.size();) {
+        if (a.keys[ka] < b.keys[kb]) {
+            ka++;
+            continue;
+        }
+        if (a.keys[ka] > b.keys[kb]) {
+            kb++;
+            continue;
+        }
+        const Container &x = a.containers[ka++], &y = b.containers[kb++];
+        bool denseX = x.size > ARRAY_MAX, denseY = y.size > ARRAY_MAX;
+        if (denseX && denseY) {
+            for (size_t w = 0; w < (1 << 16) / 64; w++) {
+                count += std::popcount(a.bitmaps[x.start + w] & b.bitmaps[y.start + w]);
+            }
+        } else if (denseX || denseY) {
+            // probe the ids of the array in the bitmap
+            const Row &sparse = denseX ? b : a, &dense = denseX ? a : b;
+            const Container &s = denseX ? y : x, &d = denseX ? x : y;
+            for (uint32_t i = 0; i < s.size; i++) {
+                uint16_t low = sparse.arrays[s.start + i];
+                count += (dense.bitmaps[d.start + (low >> 6)] >> (low & 63)) & 1;
+            }
+        } else {
+            const uint16_t *i = a.arrays.data() + x.start, *iEnd = i + x.size;
+            const uint16_t *j = b.arrays.data() + y.start, *jEnd = j + y.size;
+            while (i != iEnd && j != jEnd) {
+                if (*i < *j) {
+                    i++;
+                } else if (*i > *j) {
+                    j++;
+                } else {
+                    count++;
+                    i++;
+                    j++;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace gm
@@ -0,0 +1,90 @@
+#ifndef GM_HUBS_HPP
+#define GM_HUBS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "graph/types.hpp"
+#include "stats.hpp"
+
+namespace gm {
+
+/// Neighbourhoods of the vertices of degree at least minDegree ("hubs") as bitmaps, next to
+/// the CSR of a graph. As in Roaring bitmaps a row is split into containers of 2^16 ids: one
+/// with more than ARRAY_MAX ids is a 2^16 bit bitmap, a sparser one a sorted array of the low
+/// 16 bits. Each row keeps the high 16 bits of its containers sorted, so contains() is a binary
+/// search in those keys, then a bit test or a binary search in at most ARRAY_MAX ids.
+class HubRows {
+public:
+    /// --hub-degree, 0 for no hub rows
+    static inline v_int minDegree = 0;
+    static constexpr uint32_t ARRAY_MAX = 4096;
+    /// A contains() costs about as much as scanning this many ids of a list
+    static constexpr int64_t PROBE_COST = 4;
+
+    /// Rows of the vertices of degree at least minDegree of a graph with n vertices
+    HubRows(v_int n, const v_int *off, const v_int *e, v_int minDegree);
+
+    v_int threshold() const {
+        return threshold_;
+    }
+    v_int size() const {
+        return rows.size();
+    }
+    bool isHub(v_int u) const {
+        return index[u] >= 0;
+    }
+    /// Whether most neighbours of the hub u are in bitmaps. Only then does intersecting with its
+    /// row beat the (vectorised) merge of the CSR lists.
+    bool dense(v_int u) const {
+        const Row &row = rows[index[u]];
+        return 2 * row.denseIds >= row.ids;
+    }
+    /// Whether v is a neighbour of the hub u
+    bool contains(v_int u, v_int v) const {
+        const Row &row = rows[index[u]];
+        uint16_t high = v >> 16;
+        auto key = std::lower_bound(row.keys.begin(), row.keys.end(), high);
+        if (key == row.keys.end() || *key != high) { return false; }
+        const Container &container = row.containers[key - row.keys.begin()];
+        uint16_t low = v & 0xffff;
+        if (container.size > ARRAY_MAX) {
+            return (row.bitmaps[container.start + (low >> 6)] >> (low & 63)) & 1;
+        }
+        const uint16_t *begin = row.arrays.data() + container.start;
+        return std::binary_search(begin, begin + container.size, low);
+    }
+    /// Number of the ids in [first, last) that are neighbours of the hub u
+    size_t countIn(v_int u, const v_int *first, const v_int *last) const {
+        size_t count = 0;
+        for (; first != last; ++first) { count += contains(u, *first); }
+        return count;
+    }
+    /// Number of common neighbours of the hubs u and v, merging their keys and intersecting the
+    /// containers of the keys they share
+    size_t commonCount(v_int u, v_int v) const;
+
+private:
+    struct Container {
+        uint32_t start; // first word in bitmaps, or first id in arrays
+        uint32_t size;  // number of ids
+    };
+    struct Row {
+        std::vector<uint16_t> keys; // id >> 16 of each container, increasing
+        std::vector<Container> containers;
+        std::vector<uint16_t> arrays;
+        std::vector<uint64_t> bitmaps;
+        uint32_t ids = 0, denseIds = 0; // neighbours, and those in bitmaps
+    };
+
+    v_int threshold_;
+    std::vector<int32_t> index; // vertex -> row, -1 if not a hub
+    std::vector<Row> rows;
+    TrackedBytes bytes{Memory::Hubs};
+};
+
+} // namespace gm
+
+#endif // GM_HUBS_HPP
@@ -0,0 +1,169 @@
+#include "graph/intersect.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "graph/types.hpp"
+
+namespace gm {
+
+namespace {
+
+// Write selects intersectIndices (true) or intersectCount (false)
+template<bool Write>
+size_t mergeScalar(const v_int *a, size_t na, const v_int *b, size_t nb, v_int *out, size_t i = 0,
+                   size_t j = 0, size_t count = 0) {
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (a[i] > b[j]) {
+            j++;
+        } else {
+            if constexpr (Write) { out[count] = i; }
+            count++;
+            i++;
+            j++;
+        }
+    }
+    return count;
+}
+
+// Look up every element of the short list in the long one by exponential search from the
+// previous match. Indices written are into a, which is the short list if ShortIsA.
+template<bool Write, bool ShortIsA>
+size_t gallop(const v_int *s, size_t ns, const v_int *l, size_t nl, v_int *out) {
+    size_t count = 0, lo = 0;
+    for (size_t i = 0; i < ns && lo < nl; i++) {
+        v_int x = s[i];
+        size_t hi = lo, step = 1;
+        while (hi < nl && l[hi] < x) {
+            lo = hi + 1;
+            hi += step;
+            step *= 2;
+        }
+        lo = std::lower_bound(l + lo, l + std::min(hi, nl), x) - l;
+        if (lo < nl && l[lo] == x) {
+            if constexpr (Write) { out[count] = ShortIsA ? i : lo; }
+            count++;
+            lo++;
+        }
+    }
+    return count;
+}
+
+#if defined(__x86_64__)
+
+// Compare a block of a with every rotation of a block of b, then advance the block with the
+// smaller maximum (or both). The rest is merged with scalar code.
+template<bool Write>
+__attribute__((target("avx2"))) size_t mergeAvx2(const v_int *a, size_t na, const v_int *b, size_t nb,
+                                                 v_int *out) {
+    size_t i = 0, j = 0, count = 0;
+    const __m256i rotate = _mm256_set_epi32(0, 7, 6, 5, 4, 3, 2, 1);
+    while (i + 8 <= na && j + 8 <= nb) {
+        __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *) (b + j));
+        __m256i eq = _mm256_cmpeq_epi32(va, vb);
+        for (int r = 1; r < 8; r++) {
+            vb = _mm256_permutevar8x32_epi32(vb, rotate);
+            eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+        }
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+        if constexpr (Write) {
+            for (; mask; mask &= mask - 1) { out[count++] = i + std::countr_zero(mask); }
+        } else {
+            count += std::popcount(mask);
+        }
+        v_int aMax = a[i + 7], bMax = b[j + 7];
+        if (aMax <= bMax) { i += 8; }
+        if (bMax <= aMax) { j += 8; }
+    }
+    return mergeScalar<Write>(a, na, b, nb, out, i, j, count);
+}
+
+template<bool Write>
+__attribute__((target("avx512f"))) size_t mergeAvx512(const v_int *a, size_t na, const v_int *b,
+                                                      size_t nb, v_int *out) {
+    size_t i = 0, j = 0, count = 0;
+    const __m512i lanes = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m512i rotate = _mm512_set_epi32(0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    while (i + 16 <= na && j + 16 <= nb) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + j);
+        __mmask16 mask = _mm512_cmpeq_epi32_mask(va, vb);
+        for (int r = 1; r < 16; r++) {
+            // the unmasked permutes of GCC 12 pass _mm512_undefined_epi32(), which
+            // -Wmaybe-uninitialized flags; with every lane selected this is the same rotate
+            vb = _mm512_maskz_permutexvar_epi32(0xffff, rotate, vb);
+            mask |= _mm512_cmpeq_epi32_mask(va, vb);
+        }
+        if constexpr (Write) {
+            __m512i index = _mm512_add_epi32(_mm512_set1_epi32(v_int(i)), lanes);
+            _mm512_mask_compressstoreu_epi32(out + count, mask, index);
+        }
+        count += std::popcount(unsigned(mask));
+        v_int aMax = a[i + 15], bMax = b[j + 15];
+        if (aMax <= bMax) { i += 16; }
+        if (bMax <= aMax) { j += 16; }
+    }
+    return mergeScalar<Write>(a, na, b, nb, out, i, j, count);
+}
+
+#endif
+
+using Kernel = size_t (*)(const v_int *, size_t, const v_int *, size_t, v_int *);
+
+struct Kernels {
+    const char *name;
+    Kernel indices;
+    Kernel count;
+};
+
+Kernels selectKernels() {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return {"avx512", mergeAvx512<true>, mergeAvx512<false>};
+    }
+    if (__builtin_cpu_supports("avx2")) { return {"avx2", mergeAvx2<true>, mergeAvx2<false>}; }
+#endif
+    return {"scalar",
+            [](const v_int *a, size_t na, const v_int *b, size_t nb, v_int *out) {
+                return mergeScalar<true>(a, na, b, nb, out);
+            },
+            [](const v_int *a, size_t na, const v_int *b, size_t nb, v_int *out) {
+                return mergeScalar<false>(a, na, b, nb, out);
+            }};
+}
+
+const Kernels kernels = selectKernels();
+
+// Below this size ratio the block merge beats galloping
+constexpr size_t GALLOP_RATIO = 8;
+
+} // namespace
+
+size_t intersectIndices(const v_int *a, size_t na, const v_int *b, size_t nb, v_int *out) {
+    if (na == 0 || nb == 0) { return 0; }
+    if (na * GALLOP_RATIO < nb) { return gallop<true, true>(a, na, b, nb, out); }
+    if (nb * GALLOP_RATIO < na) { return gallop<true, false>(b, nb, a, na, out); }
+    return kernels.indices(a, na, b, nb, out);
+}
+
+size_t intersectCount(const v_int *a, size_t na, const v_int *b, size_t nb) {
+    if (na == 0 || nb == 0) { return 0; }
+    if (na * GALLOP_RATIO < nb) { return gallop<false, true>(a, na, b, nb, nullptr); }
+    if (nb * GALLOP_RATIO < na) { return gallop<false, false>(b, nb, a, na, nullptr); }
+    return kernels.count(a, na, b, nb, nullptr);
+}
+
+const char *intersectKernel() {
+    return kernels.name;
+}
+
+} // namespace gm
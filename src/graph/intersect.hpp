@@ -0,0 +1,26 @@
+#ifndef GM_INTERSECT_HPP
+#define GM_INTERSECT_HPP
+
+#include <cstddef>
+
+#include "graph/types.hpp"
+
+namespace gm {
+
+/// Intersection of two ascending lists without duplicates. Writes the index in a of every
+/// common element to out, in ascending order, and returns how many there are. out needs
+/// room for min(na, nb) entries.
+///
+/// Uses AVX-512 or AVX2 block compares when the CPU has them (checked once at startup),
+/// a scalar merge otherwise, and galloping when one list is much shorter than the other.
+size_t intersectIndices(const v_int *a, size_t na, const v_int *b, size_t nb, v_int *out);
+
+/// Size of the intersection of two ascending lists without duplicates
+size_t intersectCount(const v_int *a, size_t na, const v_int *b, size_t nb);
+
+/// "avx512", "avx2" or "scalar"
+const char *intersectKernel();
+
+} // namespace gm
+
+#endif // GM_INTERSECT_HPP
@@ -1,7 +1,14 @@
 #include "graph/kdefective.hpp"
+#include "graph/bounds.hpp"
+#include "graph/dynamic.hpp"
+#include "graph/egoloop.hpp"
 #include "graph/graph.hpp"
 #include "graph/graphv2.hpp"
+#include "graph/peel.hpp"
 #include "graph/types.hpp"
+#include "perf.hpp"
+#include "scratch.hpp"
+#include "stats.hpp"
 #include "util.hpp"
 #include <iostream>
 #include <vector>
@@ -28,20 +35,23 @@ kDefResult kDefNaive(Graph &g, v_int k) {
     return result;
 }
 
-kDefResult kDefNaiveV2(v2::GraphV2 &g, v_int k) {
+template<class G>
+kDefResult kDefNaiveV2(G &g, v_int k) {
     kDefResult result{};
     v_int size = g.size();
     auto ordering = degenOrdering(g);
-    std::vector<uint8_t> included(size, 0);
+    EpochMarks<> &included = scratch().members;
+    included.resize(size);
+    included.clear();
     std::vector<v_id> solution{};
     v_int totalEdges = 0;
     for (v_int idx = size - 1; idx >= 0; idx--) {
         v_id u = ordering[idx];
         v_int addedEdges = 0;
         solution.push_back(u);
-        included[u] = 1;
+        included.insert(u);
         for (v_int v : g.iterNeighbours(u)) {
-            if (included[v] && u != v) { addedEdges++; }
+            if (included.contains(v) && u != v) { addedEdges++; }
         }
         totalEdges += addedEdges;
         // cout << totalEdges << " - ";
@@ -56,13 +66,16 @@ kDefResult kDefNaiveV2(v2::GraphV2 &g, v_int k) {
     return result;
 }
 
+template kDefResult kDefNaiveV2(v2::GraphV2 &g, v_int k);
+template kDefResult kDefNaiveV2(v2::SmallGraph &g, v_int k);
+
 // not used, only v2 is used for now
 kDefResult kDefDegen(Graph &g, v_int k) {
     kDefResult solution{};
     v_int size = g.size();
     vector<v_id> ordering = degenOrdering(g);
     vector<v_id> degenRank(size, 0); // vertex id -> degeneracy rank from 0 to (n - 1)
-    std::vector<int> removed(size, 0);
+    std::vector<uint8_t> removed(size, 0);
 
     for (v_int i = 0; i < size; i++) { degenRank[ordering[i]] = i; }
     // order neighbours by degeneracy ordering (reversed)
@@ -77,38 +90,36 @@ kDefResult kDefDegen(Graph &g, v_int k) {
     // Generate a subgraph
     for (v_id i = 0; i < size; i++) {
         if (removed[i]) { continue; }
-        vector<v_id> vertices;
-        vector<int> included(size, 0);
-        included[i] = 1;
+        vector<v_id> vertices{i};
         auto &neighbours = g.neighbours(i);
         // Add neighbours and two-hop neighbours to subgraph
         for (v_id j : neighbours) {
             if (!removed[j]) {
                 if (degenRank[j] < degenRank[i]) { break; }
-                included[j] = 1;
+                vertices.push_back(j);
             }
         }
-        for (v_id j = 0; j < size; j++) {
-            if (included[j]) { vertices.push_back(j); }
-        }
+        std::sort(vertices.begin(), vertices.end());
         // if (vertices.size() < initialSize) { continue; }
 
         // Create subgraph
         // Graph subgraph = g.subgraph(vertices);
         Graph subgraph(vertices.size());
-        vector<v_id> vMap(size, -1);
+        EpochMap<v_int> &vMap = scratch().position;
+        vMap.resize(size);
+        vMap.clear();
         v_id nextId = 0;
         for (v_id v : vertices) {
-            vMap[v] = nextId;
+            vMap.set(v, nextId);
             nextId++;
         }
         for (v_id u : vertices) {
             for (v_id v : g.neighbours(u)) {
                 // Optimize with degenRank as the neighbours arrays are ordered
                 if (degenRank[u] < degenRank[v]) {
-                    if (vMap[v] >= 0) {
+                    if (vMap.get(v, -1) >= 0) {
                         // cerr << "addEdge " << vMap[u] << " " << vMap[v] << endl;
-                        subgraph.addEdge(vMap[u], vMap[v]);
+                        subgraph.addEdge(vMap.get(u, -1), vMap.get(v, -1));
                     }
                 } else {
                     break;
@@ -130,78 +141,35 @@ kDefResult kDefDegen(Graph &g, v_int k) {
 }
 
 kDefResult kDefDegenV2(v2::GraphV2 &g, v_int k, bool twoHop) {
-    kDefResult solution = kDefNaiveV2(g, k);
-    v_int size = g.size();
-    vector<v_id> ordering = degenOrdering(g);
-    vector<v_id> degenRank(size, 0); // vertex id -> degeneracy rank from 0 to (n - 1)
-
-    for (v_int i = 0; i < size; i++) { degenRank[ordering[i]] = i; }
-    // order neighbours by degeneracy ordering (reversed)
-    for (v_id i = 0; i < size; i++) {
-        auto neighbours = g.iterNeighbours(i);
-        std::sort(neighbours.begin(), neighbours.end(), [&](v_id v1, v_id v2) {
-            return degenRank[v1] > degenRank[v2];
-        });
-    }
-
-    vector<uint8_t> included(size, 0);
-    // Generate a subgraph
-    // parallelise w/ openmp
-    for (v_id u = 0; u < size; u++) {
-        if (g.degree(u) <= solution.size - k - 1) { continue; }
-        vector<v_id> vertices;
-        vertices.push_back(u);
-        included[u] = 1;
-        auto neighbours = g.iterNeighbours(u);
-        // Add neighbours and two-hop neighbours to subgraph
-        for (v_id v : neighbours) {
-            if (degenRank[v] < degenRank[u]) { break; }
-            if (g.degree(v) <= solution.size - k - 1) { continue; }
-
-            if (!included[v]) {
-                included[v] = 1;
-                vertices.push_back(v);
-            }
-            if (twoHop) {
-                for (v_int w : g.iterNeighbours(v)) {
-                    if (degenRank[w] < degenRank[u]) { break; }
-                    if (g.degree(w) <= solution.size - k - 1) { continue; }
-
-                    if (!included[w]) {
-                        included[w] = 1;
-                        vertices.push_back(w);
-                    }
-                }
-            }
-        }
+    PeelResult peel = peelGraph(g, k, 0.);
+    stats().set("initial_size", peel.kDef.size);
+    RankedGraph ranked = rankGraph(g, peel.ordering);
+    releaseGraph(g);
 
-        if (int(vertices.size()) > solution.size) {
-            // Create subgraph
-            auto subgraph = v2::subgraphDegen(g, vertices, degenRank.data());
-
-            auto newSolution = kDefNaiveV2(subgraph, k);
-            if (newSolution.kDefective.size() > solution.kDefective.size()) {
-                for (size_t i = 0; i < newSolution.kDefective.size(); i++) {
-                    newSolution.kDefective[i] = vertices[newSolution.kDefective[i]];
-                }
-                cout << "Found better solution of size " << newSolution.kDefective.size() << endl;
-                solution = std::move(newSolution);
-            }
-        }
-        for (auto v : vertices) { included[v] = 0; }
-    }
+    kDefResult solution{};
+    solution.kDefective = egoLoop(ranked, KDefModel{.k = k}, twoHop, std::move(peel.kDef.kDefective));
+    g = unrankGraph(ranked);
+    solution.size = solution.kDefective.size();
     return solution;
 }
 
+std::vector<v_id> kDefTemporal(const TemporalEdges &stream, v_int k, bool twoHop, int64_t window,
+                               int64_t slide, v2::Graph &last) {
+    return solveTemporal(stream, KDefModel{.k = k}, twoHop, window, slide, last);
+}
+
 bool checkKDef(Graph &g, const std::vector<v_id> &vs, v_int k) {
     v_int size = g.size();
     v_int target = vs.size() * (vs.size() - 1) / 2;
-    std::vector<uint8_t> included(size, 0);
+    // the neighbours of g may be in any order, so mark the vertices instead
+    EpochMarks<> &included = scratch().members;
+    included.resize(size);
+    included.clear();
     v_int count = 0;
-    for (v_id u : vs) { included[u] = 1; }
+    for (v_id u : vs) { included.insert(u); }
     for (v_id u : vs) {
         for (v_id v : g.neighbours(u)) {
-            if (u < v && included[v]) { count++; }
+            if (u < v && included.contains(v)) { count++; }
         }
     }
     if (target - count > k) { return false; }
@@ -209,17 +177,16 @@ bool checkKDef(Graph &g, const std::vector<v_id> &vs, v_int k) {
 }
 
 bool checkKDefV2(v2::GraphV2 &g, const std::vector<v_id> &vs, v_int k) {
-    v_int size = g.size();
+    PhaseTimer timer{Phase::Validate};
+    PerfScope perfScope{PerfPhase::Validate};
     int64_t target = int64_t(vs.size()) * (vs.size() - 1) / 2;
-    std::vector<uint8_t> included(size, 0);
-    v_int count = 0;
-    for (v_id u : vs) { included[u] = 1; }
+    std::vector<v_int> &sorted = sortedSolution(vs);
+    int64_t count = 0;
     for (v_id u : vs) {
-        for (v_id v : g.iterNeighbours(u)) {
-            if (u < v && included[v]) { count++; }
-        }
+        count += g.adjacentCount(u, sorted.data(), sorted.size());
     }
-    if (target - count > k) { return false; }
+    // every edge is counted from both ends
+    if (target - count / 2 > k) { return false; }
     return true;
 }
 
@@ -1,9 +1,12 @@
 #ifndef GM_KDEFECTIVE_HPP
 #define GM_KDEFECTIVE_HPP
 
+#include "graph/bounds.hpp"
+#include "graph/dynamic.hpp"
 #include "graph/graph.hpp"
 #include "graph/graphv2.hpp"
 #include "graph/types.hpp"
+#include <algorithm>
 #include <vector>
 
 namespace gm {
@@ -14,9 +17,48 @@ struct kDefResult {
 };
 
 kDefResult kDefNaive(Graph &g, v_int k);
-kDefResult kDefNaiveV2(v2::GraphV2 &g, v_int k);
+template<class G>
+kDefResult kDefNaiveV2(G &g, v_int k);
 kDefResult kDefDegen(Graph &g, v_int k);
+/// The ego network model of kDefDegenV2 and allModels (see egoLoop)
+struct KDefModel {
+    const char *name = "kDef";
+    v_int k;
+
+    bool skipRoot(v_int degree, v_int best) const {
+        return degree <= best - k - 1;
+    }
+    bool skipCandidate(v_int degree, v_int best) const {
+        return degree <= best - k - 1;
+    }
+    bool skipRest(v_int later, v_int best) const {
+        return skipRoot(later, best);
+    }
+    // each of the other s - 2 vertices not adjacent to both u and v costs a missing edge
+    v_int minSupport(v_int best) const {
+        return best - 1 - k;
+    }
+    // the missing edge between u and w leaves k - 1 for the other s - 2 vertices
+    v_int minCommon(v_int best) const {
+        return best - k;
+    }
+    template<class G>
+    v_int upperBound(G &subgraph) const {
+        v_int colored = coloringBound(colorClasses(subgraph), k);
+        v_int bounded =
+            degreeBound(degreesDescending(subgraph), [&](v_int s) { return s - 1 - k; });
+        return std::min(colored, bounded);
+    }
+    template<class G>
+    std::vector<v_id> solve(G &subgraph) const {
+        return kDefNaiveV2(subgraph, k).kDefective;
+    }
+};
+
 kDefResult kDefDegenV2(v2::GraphV2 &g, v_int k, bool twoHop = false);
+/// Largest k-defective clique of every window of stream (see solveTemporal), returns the last one
+std::vector<v_id> kDefTemporal(const TemporalEdges &stream, v_int k, bool twoHop, int64_t window,
+                               int64_t slide, v2::Graph &last);
 
 bool checkKDef(Graph &g, const std::vector<v_id> &vs, v_int k);
 bool checkKDefV2(v2::GraphV2 &g, const std::vector<v_id> &vs, v_int k);
@@ -1,8 +1,15 @@
 #include "graph/kplex.hpp"
 
+#include "graph/bounds.hpp"
+#include "graph/dynamic.hpp"
+#include "graph/egoloop.hpp"
 #include "graph/graphv2.hpp"
+#include "graph/peel.hpp"
 #include "graph/types.hpp"
 #include "heap.hpp"
+#include "perf.hpp"
+#include "scratch.hpp"
+#include "stats.hpp"
 #include "util.hpp"
 #include <algorithm>
 #include <cstdint>
@@ -15,15 +22,18 @@ namespace gm {
 using namespace std;
 
 // Algorithm 2: kPlex-Degen
-KPlexDegenResult kPlexDegen(v2::Graph &g, int64_t k) {
+template<class G>
+KPlexDegenResult kPlexDegen(G &g, int64_t k) {
+    using Id = typename G::Id;
     KPlexDegenResult result = {.kPlex = {}, .ub = 0};
     int64_t size = g.size();
 
-    std::vector<v_id> degrees;
-    std::vector<int> removed(size, 0);
+    std::vector<Id> degrees;
     degrees.reserve(size);
     for (v_id i = 0; i < size; i++) { degrees.push_back(g.degree(i)); }
-    GraphLinearHeap heap(g.size(), g.size(), degrees);
+    // reused across calls, as this runs once per ego network
+    static thread_local BucketHeap<Id, Id> heap;
+    heap.reset(degrees);
 
     for (v_id i = 0; i < size; i++) {
         // Line 4
@@ -40,131 +50,57 @@ KPlexDegenResult kPlexDegen(v2::Graph &g, int64_t k) {
         if (minDeg + k >= size - i) {
             result.kPlex = {};
             for (v_id j = 0; j < size; j++) {
-                if (!removed[j]) { result.kPlex.push_back(j); }
+                if (j == v || heap.contains(j)) { result.kPlex.push_back(j); }
             }
             break;
         }
 
         // Remove current node to start next iteration
-        auto neighbours = g.iterNeighbours(v);
-        for (v_id w : neighbours) {
-            if (!removed[w]) {
-                degrees[w] -= 1;
-                auto res = heap.decrement(w, 1);
-                GM_ASSERT(res, "should success");
-            }
-        }
-        removed[v] = 1;
+        heap.decrementBatch(g.edges(v), g.edgesEnd(v));
     }
     return result;
 }
 
-KPlexDegenResult kPlexV2(v2::GraphV2 &g, int64_t k, bool twoHop) {
-    v_int size = g.size();
-    auto initialSolution = kPlexDegen(g, k);
-    v_int initialSize = initialSolution.kPlex.size();
-    KPlexDegenResult solution = initialSolution;
-
-    cout << "Initial solution size = " << initialSize << endl;
-
-    vector<v_id> ordering = degenOrdering(g);
-    // for (size_t i = 0; i < ordering.size(); i++) { cout << ordering[i] << " "; }
-    // cout << "\n";
-    vector<v_id> degenRank(size, 0); // vertex id -> degeneracy rank from 0 to (n - 1)
-    for (v_int i = 0; i < size; i++) { degenRank[ordering[i]] = i; }
-    // order neighbours by degeneracy ordering (reversed)
-    for (v_id i = 0; i < size; i++) {
-        auto neighbours = g.iterNeighbours(i);
-        std::sort(neighbours.begin(), neighbours.end(), [&](v_id v1, v_id v2) {
-            return degenRank[v1] > degenRank[v2];
-        });
-    }
+template KPlexDegenResult kPlexDegen(v2::Graph &g, int64_t k);
+template KPlexDegenResult kPlexDegen(v2::SmallGraph &g, int64_t k);
 
-    // vector<v_id> vMap(size, -1);
-    vector<uint8_t> included(size, 0);
-
-    // Generate a subgraph
-    for (v_id u = 0; u < size; u++) {
-        // Any vertex with (degree < initialSize - k) definitely won't be in a better answer
-        if (g.degree(u) <= solution.kPlex.size() - k) { continue; }
-        vector<v_id> vertices;
-        vertices.push_back(u);
-        included[u] = 1;
-        auto neighbours = g.iterNeighbours(u);
-        // Add neighbours and two-hop neighbours to subgraph
-        for (v_id v : neighbours) {
-            if (degenRank[v] < degenRank[u]) { break; }
-            if (g.degree(v) <= solution.kPlex.size() - k) { continue; }
-
-            if (!included[v]) {
-                included[v] = 1;
-                vertices.push_back(v);
-            }
-            if (twoHop) {
-                for (v_id w : g.iterNeighbours(v)) {
-                    if (degenRank[w] < degenRank[u]) { break; }
-                    if (g.degree(w) <= solution.kPlex.size() - k) { continue; }
-                    if (!included[w]) {
-                        included[w] = 1;
-                        vertices.push_back(w);
-                    }
-                }
-            }
-        }
-        // cout << "u=" << u << " ";
-        // for (size_t i = 0; i < vertices.size(); i++) { cout << vertices[i] << " "; }
-        // cout << "\n";
-        if (vertices.size() <= solution.kPlex.size()) {
-            for (auto v : vertices) {
-                // vMap[v] = -1;
-                included[v] = 0;
-            }
-            continue;
-        }
+KPlexDegenResult kPlexV2(v2::GraphV2 &g, int64_t k, bool twoHop) {
+    PeelResult peel = peelGraph(g, k, 0.);
+    KPlexDegenResult solution = std::move(peel.kPlex);
 
-        // Create subgraph
-        // v2::Graph subgraph = g.subgraph(vertices);
-        v2::Graph subgraph = v2::subgraphDegen(g, vertices, degenRank.data());
-        // auto subgraph = v2::subgraphDegen(g, vertices, &vMap, degenRank.data());
-        // v_id nextId = 0;
-        // for (v_id v : vertices) {
-        //     vMap[v] = nextId;
-        //     nextId++;
-        // }
-
-        // cout << "calculating subgraph (size=" << subgraph.size() << ")" << endl;
-        auto newSolution = kPlexDegen(subgraph, k);
-        if (newSolution.kPlex.size() > solution.kPlex.size()) {
-            // Map subgraph vertices back
-            for (size_t i = 0; i < newSolution.kPlex.size(); i++) {
-                newSolution.kPlex[i] = vertices[newSolution.kPlex[i]];
-            }
-            // cout << "Found better solution size = " << newSolution.kPlex.size() << endl;
-            solution = std::move(newSolution);
-        }
+    cout << "Initial solution size = " << solution.kPlex.size() << endl;
+    stats().set("initial_size", solution.kPlex.size());
 
-        // reset:
-        for (auto v : vertices) {
-            // vMap[v] = -1;
-            included[v] = 0;
-        }
-    }
+    RankedGraph ranked = rankGraph(g, peel.ordering);
+    releaseGraph(g);
+    solution.kPlex = egoLoop(ranked, KPlexModel{.k = k}, twoHop, std::move(solution.kPlex));
+    g = unrankGraph(ranked);
+    return solution;
+}
 
+KPlexDegenResult kPlexDynamic(v2::Graph &g, int64_t k, bool twoHop, const std::string &updatesPath) {
+    PeelResult peel = peelGraph(g, k, 0.);
+    stats().set("initial_size", peel.kPlex.kPlex.size());
+    // the peel's upper bound is for the graph before the updates
+    KPlexDegenResult solution{.kPlex = {}, .ub = -1};
+    solution.kPlex = solveDynamic(g, KPlexModel{.k = k}, twoHop, std::move(peel.coreNumber),
+                                  std::move(peel.kPlex.kPlex), updatesPath);
     return solution;
 }
 
-bool validateKPlex(v2::Graph &g, std::vector<v_id> kplex, int k) {
-    v_int size = g.size();
-    std::vector<int> isInKplex(size, 0);
-    for (v_id u : kplex) { isInKplex[u] = 1; }
+std::vector<v_id> kPlexTemporal(const TemporalEdges &stream, int64_t k, bool twoHop,
+                                int64_t window, int64_t slide, v2::Graph &last) {
+    return solveTemporal(stream, KPlexModel{.k = k}, twoHop, window, slide, last);
+}
 
-    for (size_t i = 0; i < kplex.size(); i++) {
-        v_id u = kplex[i];
-        int numConnections = 0;
-        for (v_id v : g.iterNeighbours(u)) {
-            if (isInKplex[v]) { numConnections++; }
-        }
-        if (numConnections < kplex.size() - k) { return false; }
+bool validateKPlex(v2::Graph &g, const std::vector<v_id> &kplex, int k) {
+    PhaseTimer timer{Phase::Validate};
+    PerfScope perfScope{PerfPhase::Validate};
+    std::vector<v_int> &sorted = sortedSolution(kplex);
+
+    for (v_id u : kplex) {
+        int64_t numConnections = g.adjacentCount(u, sorted.data(), sorted.size());
+        if (numConnections < int64_t(kplex.size()) - k) { return false; }
     }
     return true;
 }
@@ -1,7 +1,12 @@
 #ifndef GM_KPLEX_HPP
 #define GM_KPLEX_HPP
 
+#include "graph/bounds.hpp"
+#include "graph/dynamic.hpp"
 #include "graph/graphv2.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace gm {
@@ -11,11 +16,57 @@ struct KPlexDegenResult {
     int64_t ub;
 };
 
-KPlexDegenResult kPlexDegen(v2::Graph &g, int64_t k);
+template<class G>
+KPlexDegenResult kPlexDegen(G &g, int64_t k);
+
+/// The ego network model of kPlexV2 and allModels (see egoLoop)
+struct KPlexModel {
+    const char *name = "kPlexV2";
+    int64_t k;
+
+    // Any vertex with (degree <= best - k) definitely won't be in a better answer
+    bool skipRoot(v_int degree, v_int best) const {
+        return degree <= best - k;
+    }
+    bool skipCandidate(v_int degree, v_int best) const {
+        return degree <= best - k;
+    }
+    bool skipRest(v_int later, v_int best) const {
+        return skipRoot(later, best);
+    }
+    // u, v in a k-plex of size s have at least s - 2k common neighbours in it
+    v_int minSupport(v_int best) const {
+        return best + 1 - 2 * k;
+    }
+    // u, w not adjacent in a k-plex of size s both have s - k neighbours among the other s - 2
+    v_int minCommon(v_int best) const {
+        return best + 3 - 2 * k;
+    }
+    // at most k vertices of a k-plex are pairwise non-adjacent, and each has s - k neighbours
+    template<class G>
+    v_int upperBound(G &subgraph) const {
+        v_int colored = 0;
+        for (v_int size : colorClasses(subgraph)) { colored += std::min<v_int>(size, k); }
+        v_int bounded = degreeBound(degreesDescending(subgraph), [&](v_int s) { return s - k; });
+        return std::min(colored, bounded);
+    }
+    template<class G>
+    std::vector<v_id> solve(G &subgraph) const {
+        return kPlexDegen(subgraph, k).kPlex;
+    }
+};
 
 KPlexDegenResult kPlexV2(v2::Graph &g, int64_t k, bool twoHop);
 
-bool validateKPlex(v2::Graph &g, std::vector<v_id> kplex, int k);
+/// kPlexV2, then kept up to date through the edge updates in updatesPath (see solveDynamic).
+/// g becomes the graph after the updates.
+KPlexDegenResult kPlexDynamic(v2::Graph &g, int64_t k, bool twoHop, const std::string &updatesPath);
+
+/// Largest k-plex of every window of stream (see solveTemporal), returns the last one
+std::vector<v_id> kPlexTemporal(const TemporalEdges &stream, int64_t k, bool twoHop,
+                                int64_t window, int64_t slide, v2::Graph &last);
+
+bool validateKPlex(v2::Graph &g, const std::vector<v_id> &kplex, int k);
 
 
 } // namespace gm
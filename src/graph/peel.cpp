@@ -0,0 +1,134 @@
+#include "graph/peel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/hubs.hpp"
+#include "graph/types.hpp"
+#include "heap.hpp"
+#include "perf.hpp"
+#include "stats.hpp"
+
+namespace gm {
+
+using namespace std;
+
+// Suffix of the ordering in vertex id order, as kPlexDegen / quasiCliqueNaive report it
+static vector<v_id> orderingSuffix(const vector<v_id> &ordering, v_int start) {
+    vector<v_id> result(ordering.begin() + start, ordering.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// Top `count` vertices of the ordering, in the order kDefNaiveV2 / pseudoCliqueNaive add them
+static vector<v_id> orderingTop(const vector<v_id> &ordering, v_int count) {
+    return vector<v_id>(ordering.rbegin(), ordering.rbegin() + count);
+}
+
+PeelResult peelGraph(v2::Graph &g, v_int k, double alpha) {
+    PhaseTimer timer{Phase::Peel};
+    PerfScope perfScope{PerfPhase::Peel};
+    PeelResult result;
+    v_int size = g.size();
+    result.ordering.reserve(size);
+    result.degenRank.assign(size, 0);
+    result.coreNumber.assign(size, 0);
+    // ordering, degenRank and coreNumber outlive the peel
+    stats().memory(Memory::Peel, 3 * int64_t(size) * sizeof(v_id));
+
+    vector<v_id> degrees;
+    degrees.reserve(size);
+    int64_t remainingEdges = 0; // edges between vertices not peeled yet
+    for (v_id i = 0; i < size; i++) {
+        degrees.push_back(g.degree(i));
+        remainingEdges += g.degree(i);
+    }
+    remainingEdges /= 2;
+
+    // First position of the ordering where kPlexDegen / quasiCliqueNaive would stop, -1 if never
+    v_int kPlexStart = -1, quasiStart = -1;
+    // kDefNaiveV2 / pseudoCliqueNaive grow the solution from the end of the ordering and stop at
+    // the first failure, i.e. the smallest set of remaining vertices that fails the condition
+    v_int kDefFail = size + 1, pseudoFail = size + 1;
+
+    GraphBucketHeap heap(degrees);
+    TrackedBytes heapBytes{Memory::Peel, int64_t(heap.bytes() + degrees.capacity() * sizeof(v_id))};
+    for (v_int i = 0; i < size; i++) {
+        auto [v, minDeg] = heap.popMin();
+        v_int remaining = size - i;
+
+        if (kPlexStart < 0) {
+            int64_t ub = std::min<int64_t>(minDeg + k, remaining);
+            if (ub > result.kPlex.ub) { result.kPlex.ub = ub; }
+            // All nodes that's not removed form a k-plex
+            if (minDeg + k >= remaining) { kPlexStart = i; }
+        }
+        if (quasiStart < 0 && minDeg >= ceil((remaining - 1) * alpha)) { quasiStart = i; }
+
+        int64_t pairs = int64_t(remaining) * (remaining - 1) / 2;
+        if (remainingEdges + k < pairs) { kDefFail = remaining; }
+        if (remainingEdges < double(int64_t(remaining) * (remaining - 1)) / 2 * alpha) {
+            pseudoFail = remaining;
+        }
+
+        result.degeneracy = std::max(result.degeneracy, minDeg);
+        result.coreNumber[v] = result.degeneracy;
+        result.degenRank[v] = i;
+        result.ordering.push_back(v);
+        remainingEdges -= minDeg;
+        heap.decrementBatch(g.edges(v), g.edgesEnd(v));
+    }
+
+    if (kPlexStart >= 0) { result.kPlex.kPlex = orderingSuffix(result.ordering, kPlexStart); }
+    if (quasiStart >= 0) { result.quasiClique = {orderingSuffix(result.ordering, quasiStart)}; }
+    result.kDef.kDefective = orderingTop(result.ordering, kDefFail - 1);
+    result.kDef.size = result.kDef.kDefective.size();
+    result.pseudoClique = {orderingTop(result.ordering, pseudoFail - 1)};
+    return result;
+}
+
+// g relabelled so that vertex i is from[i] of g, to being the inverse of from
+static v2::Graph relabel(v2::Graph &g, const vector<v_id> &from, const vector<v_id> &to) {
+    v_int size = g.size();
+    v2::Graph result{size, g.nEdges()};
+    result.off[0] = 0;
+    for (v_id i = 0; i < size; i++) { result.off[i + 1] = result.off[i] + g.degree(from[i]); }
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (v_id i = 0; i < size; i++) {
+        v_id *out = result.edges(i);
+        for (v_id v : g.iterNeighbours(from[i])) { *out++ = to[v]; }
+        std::sort(result.edges(i), result.edgesEnd(i));
+    }
+    stats().memory(Memory::Graph, result.bytes());
+    return result;
+}
+
+RankedGraph rankGraph(v2::Graph &g, const std::vector<v_id> &ordering) {
+    PhaseTimer timer{Phase::RankSort};
+    v_int size = g.size();
+    RankedGraph result{v2::Graph{0, 0}, vector<v_id>(size), vector<v_id>(size)};
+    for (v_id i = 0; i < size; i++) {
+        result.original[i] = ordering[size - 1 - i];
+        result.ranked[result.original[i]] = i;
+    }
+    result.graph = relabel(g, result.original, result.ranked);
+    return result;
+}
+
+void releaseGraph(v2::Graph &g) {
+    stats().memory(Memory::Graph, -g.bytes());
+    g = v2::Graph{0, 0};
+}
+
+v2::Graph unrankGraph(RankedGraph &ranked) {
+    PhaseTimer timer{Phase::RankSort};
+    v2::Graph g = relabel(ranked.graph, ranked.ranked, ranked.original);
+    if (ranked.graph.hubs) { g.buildHubs(ranked.graph.hubs->threshold()); }
+    releaseGraph(ranked.graph);
+    return g;
+}
+
+} // namespace gm
@@ -0,0 +1,53 @@
+#ifndef GM_PEEL_HPP
+#define GM_PEEL_HPP
+
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/kdefective.hpp"
+#include "graph/kplex.hpp"
+#include "graph/types.hpp"
+
+namespace gm {
+
+/// Everything the drivers need from peeling the input graph once.
+struct PeelResult {
+    std::vector<v_id> ordering;    // degeneracy ordering
+    std::vector<v_id> degenRank;   // vertex id -> degeneracy rank from 0 to (n - 1)
+    std::vector<v_int> coreNumber; // vertex id -> core number
+    v_int degeneracy = 0;
+
+    // Initial solutions, same as kPlexDegen / kDefNaiveV2 / quasiCliqueNaive /
+    // pseudoCliqueNaive on the whole graph
+    KPlexDegenResult kPlex = {.kPlex = {}, .ub = 0};
+    kDefResult kDef{};
+    SubgraphResult quasiClique{};
+    SubgraphResult pseudoClique{};
+};
+
+/// Single min-degree peel producing the degeneracy ordering, core numbers and the
+/// initial solution of every model. k is used by k-plex and k-defective, alpha by
+/// quasi-clique and pseudo-clique.
+PeelResult peelGraph(v2::Graph &g, v_int k, double alpha);
+
+/// The input graph relabelled so that vertex i is ordering[n - 1 - i]: vertices later in the
+/// degeneracy ordering get smaller ids. Adjacency lists are sorted by id, so the neighbours
+/// later in the ordering form a prefix of each list and lists can be intersected directly.
+struct RankedGraph {
+    v2::Graph graph;
+    std::vector<v_id> original; // ranked id -> id in the input graph
+    std::vector<v_id> ranked;   // id in the input graph -> ranked id
+};
+
+RankedGraph rankGraph(v2::Graph &g, const std::vector<v_id> &ordering);
+
+/// Free g, leaving an empty graph. The drivers release the input graph once it is ranked, so
+/// that only one copy of the graph is held during the ego loop, and get it back from
+/// unrankGraph for validation.
+void releaseGraph(v2::Graph &g);
+/// The input graph of rankGraph, rebuilt from ranked, whose graph is released
+v2::Graph unrankGraph(RankedGraph &ranked);
+
+} // namespace gm
+
+#endif // GM_PEEL_HPP
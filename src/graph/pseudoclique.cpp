@@ -1,7 +1,13 @@
 #include "graph/pseudoclique.hpp"
 
+#include "graph/bounds.hpp"
+#include "graph/egoloop.hpp"
 #include "graph/graphv2.hpp"
+#include "graph/peel.hpp"
 #include "graph/types.hpp"
+#include "perf.hpp"
+#include "scratch.hpp"
+#include "stats.hpp"
 
 #include <cmath>
 #include <iostream>
@@ -11,19 +17,22 @@ using std::vector;
 
 namespace gm {
 
-SubgraphResult pseudoCliqueNaive(v2::Graph &graph, double alpha) {
+template<class G>
+SubgraphResult pseudoCliqueNaive(G &graph, double alpha) {
     v_int size = graph.size();
     auto ordering = v2::degenOrdering(graph);
     std::vector<v_int> solution{};
-    std::vector<uint8_t> included(size, 0);
+    EpochMarks<> &included = scratch().members;
+    included.resize(size);
+    included.clear();
     v_int totalEdges = 0;
     for (v_int idx = size - 1; idx >= 0; idx--) {
         v_id u = ordering[idx];
         v_int addedEdges = 0;
         solution.push_back(u);
-        included[u] = 1;
+        included.insert(u);
         for (v_int v : graph.iterNeighbours(u)) {
-            if (included[v]) { addedEdges++; }
+            if (included.contains(v)) { addedEdges++; }
         }
         totalEdges += addedEdges;
         if (totalEdges < double(solution.size() * (solution.size() - 1)) / 2 * alpha) {
@@ -35,78 +44,29 @@ SubgraphResult pseudoCliqueNaive(v2::Graph &graph, double alpha) {
     return result;
 }
 
-SubgraphResult pseudoClique(v2::Graph &graph, double alpha, bool twoHop) {
-    SubgraphResult solution = pseudoCliqueNaive(graph, alpha);
-
-    v_int size = graph.size();
-    auto ordering = v2::degenOrdering(graph);
-    vector<v_id> degenRank(size, 0);
-    for (v_int i = 0; i < size; i++) { degenRank[ordering[i]] = i; }
-    // order neighbours by degeneracy ordering (reversed)
-    for (v_id i = 0; i < size; i++) {
-        auto neighbours = graph.iterNeighbours(i);
-        std::sort(neighbours.begin(), neighbours.end(), [&](v_id v1, v_id v2) {
-            return degenRank[v1] > degenRank[v2];
-        });
-    }
-
-    // Generate a subgraph
-    vector<uint8_t> included(size, 0);
-    for (v_id u = 0; u < size; u++) {
-        if (graph.degree(u) <= floor(solution.size * alpha)) { continue; }
-        vector<v_id> vertices;
-        vertices.push_back(u);
-        included[u] = 1;
-        auto neighbours = graph.iterNeighbours(u);
-        // Add neighbours and two-hop neighbours to subgraph
-        for (v_id v : neighbours) {
-            if (degenRank[v] < degenRank[u]) { break; }
+template SubgraphResult pseudoCliqueNaive(v2::Graph &graph, double alpha);
+template SubgraphResult pseudoCliqueNaive(v2::SmallGraph &graph, double alpha);
 
-            if (!included[v]) {
-                included[v] = 1;
-                vertices.push_back(v);
-            }
-            if (twoHop) {
-                for (v_int w : graph.iterNeighbours(v)) {
-                    if (degenRank[w] < degenRank[u]) { break; }
-
-                    if (!included[w]) {
-                        included[w] = 1;
-                        vertices.push_back(w);
-                    }
-                }
-            }
-        }
-        if (vertices.size() > solution.size) {
-            // Create subgraph
-            vector<v_id> vMap;
-
-            auto subgraph = v2::subgraphDegen(graph, vertices, degenRank.data());
-
-            auto newSolution = pseudoCliqueNaive(subgraph, alpha);
-            if (newSolution.size > solution.size) {
-                for (size_t i = 0; i < newSolution.size; i++) {
-                    newSolution.subgraph[i] = vertices[newSolution.subgraph[i]];
-                }
-                solution = std::move(newSolution);
-            }
-        }
-        for (auto v : vertices) { included[v] = 0; }
-    }
-    return solution;
+SubgraphResult pseudoClique(v2::Graph &graph, double alpha, bool twoHop) {
+    PeelResult peel = peelGraph(graph, 0, alpha);
+    stats().set("initial_size", peel.pseudoClique.size);
+    RankedGraph ranked = rankGraph(graph, peel.ordering);
+    releaseGraph(graph);
+    SubgraphResult result{egoLoop(ranked, PseudoCliqueModel{.alpha = alpha}, twoHop,
+                                  std::move(peel.pseudoClique.subgraph))};
+    graph = unrankGraph(ranked);
+    return result;
 }
 
 bool validatePseudoClique(v2::Graph &graph, const std::vector<v_id> &pseudoClique, double alpha) {
-    auto size = graph.size();
+    PhaseTimer timer{Phase::Validate};
+    PerfScope perfScope{PerfPhase::Validate};
     auto threshold = std::ceil(0.5 * alpha * pseudoClique.size() * (pseudoClique.size() - 1));
-    std::vector<uint8_t> included(size, 0);
-    for (v_id u : pseudoClique) { included[u] = 1; }
+    std::vector<v_int> &sorted = sortedSolution(pseudoClique);
 
-    v_int nEdges = 0;
+    int64_t nEdges = 0;
     for (auto u : pseudoClique) {
-        for (auto v : graph.iterNeighbours(u)) {
-            if (included[v]) { nEdges++; }
-        }
+        nEdges += graph.adjacentCount(u, sorted.data(), sorted.size());
     }
     return nEdges >= threshold * 2;
 }
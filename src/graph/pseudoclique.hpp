@@ -1,14 +1,58 @@
 #ifndef GM_PSEUDOCLIQUE_HPP
 #define GM_PSEUDOCLIQUE_HPP
 
+#include <cmath>
+#include <cstdint>
 #include <vector>
 
+#include "graph/bounds.hpp"
 #include "graph/graphv2.hpp"
 #include "graph/types.hpp"
 
 namespace gm {
 
-SubgraphResult pseudoCliqueNaive(v2::Graph &graph, double alpha);
+template<class G>
+SubgraphResult pseudoCliqueNaive(G &graph, double alpha);
+/// The ego network model of pseudoClique and allModels (see egoLoop)
+struct PseudoCliqueModel {
+    const char *name = "pseudoClique";
+    double alpha;
+
+    bool skipRoot(v_int degree, v_int best) const {
+        return degree <= std::floor(best * alpha);
+    }
+    bool skipCandidate(v_int /*degree*/, v_int /*best*/) const {
+        return false;
+    }
+    // only the average degree of a pseudo-clique is bounded, not the degree of its root
+    bool skipRest(v_int /*later*/, v_int /*best*/) const {
+        return false;
+    }
+    // density alone doesn't bound the support of an edge
+    v_int minSupport(v_int /*best*/) const {
+        return 0;
+    }
+    v_int minCommon(v_int /*best*/) const {
+        return 0;
+    }
+    // the s largest degrees have to add up to twice the edges a pseudo-clique of size s has
+    template<class G>
+    v_int upperBound(G &subgraph) const {
+        const std::vector<v_int> &degrees = degreesDescending(subgraph);
+        v_int bound = 0;
+        int64_t degreeSum = 0;
+        for (v_int s = 1; s <= v_int(degrees.size()); s++) {
+            degreeSum += degrees[s - 1];
+            if (degreeSum >= 2 * std::ceil(0.5 * alpha * s * (s - 1))) { bound = s; }
+        }
+        return bound;
+    }
+    template<class G>
+    std::vector<v_id> solve(G &subgraph) const {
+        return pseudoCliqueNaive(subgraph, alpha).subgraph;
+    }
+};
+
 SubgraphResult pseudoClique(v2::Graph &graph, double alpha, bool twoHop = false);
 
 bool validatePseudoClique(v2::Graph &graph, const std::vector<v_id> &pseudoClique, double alpha);
@@ -1,15 +1,69 @@
 #ifndef GM_QUASICLIQUE_HPP
 #define GM_QUASICLIQUE_HPP
 
+#include <cmath>
+#include <string>
 #include <vector>
 
+#include "graph/bounds.hpp"
+#include "graph/dynamic.hpp"
 #include "graph/graphv2.hpp"
 #include "graph/types.hpp"
 
 namespace gm {
 
-SubgraphResult quasiCliqueNaive(v2::Graph &graph, double alpha);
+template<class G>
+SubgraphResult quasiCliqueNaive(G &graph, double alpha);
+/// The ego network model of quasiClique and allModels (see egoLoop)
+struct QuasiCliqueModel {
+    const char *name = "quasiClique";
+    double alpha;
+
+    // every vertex of a quasi-clique of size s > best has at least std::ceil(alpha (s - 1)) >=
+    // std::ceil(alpha best) neighbours in it
+    v_int minDegree(v_int best) const {
+        return std::ceil(alpha * best - 1e-9);
+    }
+    bool skipRoot(v_int degree, v_int best) const {
+        return degree < minDegree(best);
+    }
+    bool skipCandidate(v_int degree, v_int best) const {
+        return degree < minDegree(best);
+    }
+    // the root's neighbours in it are later neighbours
+    bool skipRest(v_int later, v_int best) const {
+        return later < minDegree(best);
+    }
+    // u, v in a quasi-clique of size s have at least 2 std::ceil(alpha (s - 1)) - s common
+    // neighbours in it, which for alpha > 0.5 is at least (2 alpha - 1) s - 2 alpha
+    v_int minSupport(v_int best) const {
+        if (alpha <= 0.5) { return 0; }
+        return std::ceil((2 * alpha - 1) * (best + 1) - 2 * alpha - 1e-9);
+    }
+    // u, w not adjacent both have std::ceil(alpha (s - 1)) neighbours among the other s - 2
+    v_int minCommon(v_int best) const {
+        if (alpha <= 0.5) { return 0; }
+        return std::ceil((2 * alpha - 1) * (best + 1) - 2 * alpha + 2 - 1e-9);
+    }
+    template<class G>
+    v_int upperBound(G &subgraph) const {
+        return degreeBound(degreesDescending(subgraph),
+                           [&](v_int s) { return std::ceil(alpha * (s - 1)); });
+    }
+    template<class G>
+    std::vector<v_id> solve(G &subgraph) const {
+        return quasiCliqueNaive(subgraph, alpha).subgraph;
+    }
+};
+
 SubgraphResult quasiClique(v2::Graph &graph, double alpha, bool twoHop = false);
+/// quasiClique, then kept up to date through the edge updates in updatesPath (see
+/// solveDynamic). graph becomes the graph after the updates.
+SubgraphResult quasiCliqueDynamic(v2::Graph &graph, double alpha, bool twoHop,
+                                  const std::string &updatesPath);
+/// Largest quasi-clique of every window of stream (see solveTemporal), returns the last one
+std::vector<v_id> quasiCliqueTemporal(const TemporalEdges &stream, double alpha, bool twoHop,
+                                      int64_t window, int64_t slide, v2::Graph &last);
 
 bool validateQuasiClique(v2::Graph &graph, const std::vector<v_id> &quasiClique, double alpha);
 
@@ -0,0 +1,81 @@
+#include "graph/relabel.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "graph/types.hpp"
+#include "util.hpp"
+
+namespace gm {
+
+using namespace std;
+
+void radixSort(vector<uint64_t> &keys) {
+    size_t size = keys.size();
+    uint64_t maxKey = 0;
+#pragma omp parallel for schedule(static) reduction(max : maxKey)
+    for (size_t i = 0; i < size; i++) { maxKey = std::max(maxKey, keys[i]); }
+
+    vector<uint64_t> buffer(size);
+    vector<size_t> counts; // thread t, digit d at t * 256 + d
+    for (int shift = 0; shift < 64 && (maxKey >> shift) != 0; shift += 8) {
+#pragma omp parallel
+        {
+            size_t threads = omp_get_num_threads(), t = omp_get_thread_num();
+#pragma omp single
+            counts.assign(threads * 256, 0);
+            // each thread owns a contiguous block, so the scatter is stable
+            size_t begin = size * t / threads, end = size * (t + 1) / threads;
+            size_t *local = counts.data() + t * 256;
+            for (size_t i = begin; i < end; i++) { local[(keys[i] >> shift) & 255]++; }
+#pragma omp barrier
+#pragma omp single
+            {
+                size_t sum = 0;
+                for (size_t d = 0; d < 256; d++) {
+                    for (size_t u = 0; u < threads; u++) {
+                        size_t count = counts[u * 256 + d];
+                        counts[u * 256 + d] = sum;
+                        sum += count;
+                    }
+                }
+            }
+            for (size_t i = begin; i < end; i++) {
+                buffer[local[(keys[i] >> shift) & 255]++] = keys[i];
+            }
+        }
+        swap(keys, buffer);
+    }
+}
+
+vector<pair<v_int, v_int>> compactIds(const vector<pair<int64_t, int64_t>> &edges,
+                                      vector<int64_t> &labels) {
+    vector<uint64_t> keys(2 * edges.size());
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < edges.size(); i++) {
+        GM_ASSERT(edges[i].first >= 0 && edges[i].second >= 0, "compactIds: negative vertex id");
+        keys[2 * i] = edges[i].first;
+        keys[2 * i + 1] = edges[i].second;
+    }
+    radixSort(keys);
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    GM_ASSERT(keys.size() <= size_t(numeric_limits<v_int>::max()), "compactIds: too many vertices");
+    labels.assign(keys.begin(), keys.end());
+
+    vector<pair<v_int, v_int>> compacted(edges.size());
+    auto id = [&](int64_t label) {
+        return v_int(std::lower_bound(labels.begin(), labels.end(), label) - labels.begin());
+    };
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < edges.size(); i++) {
+        compacted[i] = {id(edges[i].first), id(edges[i].second)};
+    }
+    return compacted;
+}
+
+} // namespace gm
@@ -0,0 +1,24 @@
+#ifndef GM_RELABEL_HPP
+#define GM_RELABEL_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "graph/types.hpp"
+
+namespace gm {
+
+/// Sorts keys with a parallel LSD radix sort, 8 bits per pass, skipping the passes above the
+/// largest key
+void radixSort(std::vector<uint64_t> &keys);
+
+/// Renumber the vertex labels of an edge list, which may be sparse and up to 63 bits, to dense
+/// ids from 0 in ascending order of label. labels gets the label of every id, so the label of
+/// an id is labels[id] and the id of a label is its position in labels.
+std::vector<std::pair<v_int, v_int>> compactIds(
+    const std::vector<std::pair<int64_t, int64_t>> &edges, std::vector<int64_t> &labels);
+
+} // namespace gm
+
+#endif // GM_RELABEL_HPP
@@ -0,0 +1,234 @@
+#include "graph/stream.hpp"
+
+#include <fcntl.h>
+#include <omp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef GM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef GM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "queue.hpp"
+#include "util.hpp"
+
+namespace gm {
+
+using namespace std;
+
+namespace {
+
+bool endsWith(const string &path, const string &suffix) {
+    return path.size() >= suffix.size() &&
+           path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+constexpr size_t CHUNK_BYTES = size_t(4) << 20;
+// chunks a decoder may get ahead of the parser
+constexpr size_t QUEUE_CHUNKS = 4;
+
+// A chunk of decompressed text, or with endOfFrame set, the end of the frame being decoded
+struct Chunk {
+    vector<char> data;
+    bool endOfFrame = false;
+};
+
+} // namespace
+
+/// Decoder threads and their queues. Decoder t decodes frames t, t + threads, ... in order and
+/// queues their chunks, so the parser reads the frames in order by taking frame f from queue
+/// f % threads.
+struct InputStream::Source {
+    // a decoder calls this for every frame it owns, with emit for the chunks it decodes
+    using Emit = function<void(vector<char> &, size_t)>;
+    using Decode = function<void(size_t, const Emit &)>;
+
+    string path;
+    size_t frames = 1, frame = 0;
+    vector<unique_ptr<BoundedQueue<Chunk>>> queues;
+    vector<unique_ptr<BoundedQueue<vector<char>>>> spare; // chunks handed back by the parser
+    vector<thread> decoders;
+    atomic<bool> stop{false};
+    // the compressed file, for .zst, and where each frame starts in it
+    const char *mapped = nullptr;
+    size_t mappedBytes = 0;
+    vector<size_t> frameStart;
+
+    void start(size_t threads, const Decode &decode) {
+        threads = std::max<size_t>(1, std::min(threads, frames));
+        for (size_t t = 0; t < threads; t++) {
+            queues.push_back(make_unique<BoundedQueue<Chunk>>(QUEUE_CHUNKS));
+            spare.push_back(make_unique<BoundedQueue<vector<char>>>(QUEUE_CHUNKS));
+        }
+        for (size_t t = 0; t < threads; t++) {
+            decoders.emplace_back([this, t, threads, decode] {
+                Emit emit = [&](vector<char> &buffer, size_t bytes) {
+                    buffer.resize(bytes);
+                    push(t, Chunk{std::move(buffer)});
+                    buffer.clear();
+                };
+                for (size_t f = t; f < frames; f += threads) {
+                    decode(f, emit);
+                    push(t, Chunk{{}, true});
+                }
+            });
+        }
+    }
+
+    /// An empty buffer of CHUNK_BYTES for decoder t, reusing one the parser is done with
+    vector<char> takeBuffer(size_t t) {
+        vector<char> buffer;
+        spare[t]->tryPop(buffer);
+        buffer.resize(CHUNK_BYTES);
+        return buffer;
+    }
+
+    void push(size_t t, Chunk chunk) {
+        while (!stop && !queues[t]->tryPush(chunk)) { std::this_thread::yield(); }
+    }
+
+    void startPlain() {
+        FILE *fp = fopen(path.c_str(), "rb");
+        GM_ASSERT(fp, "InputStream: cannot open " + path);
+        start(1, [this, fp](size_t, const Emit &emit) {
+            while (!stop) {
+                vector<char> buffer = takeBuffer(0);
+                size_t bytes = fread(buffer.data(), 1, buffer.size(), fp);
+                if (bytes == 0) { break; }
+                emit(buffer, bytes);
+            }
+            fclose(fp);
+        });
+    }
+
+    void startGzip() {
+#ifdef GM_HAVE_ZLIB
+        gzFile gz = gzopen(path.c_str(), "rb");
+        GM_ASSERT(gz, "InputStream: cannot open " + path);
+        gzbuffer(gz, 1 << 20);
+        start(1, [this, gz](size_t, const Emit &emit) {
+            while (!stop) {
+                vector<char> buffer = takeBuffer(0);
+                int bytes = gzread(gz, buffer.data(), buffer.size());
+                GM_ASSERT(bytes >= 0, "InputStream: corrupt gzip data in " + path);
+                if (bytes == 0) { break; }
+                emit(buffer, bytes);
+            }
+            gzclose(gz);
+        });
+#else
+        GM_ASSERT(false, "InputStream: built without zlib, cannot read " + path);
+#endif
+    }
+
+    void startZstd() {
+#ifdef GM_HAVE_ZSTD
+        int fd = open(path.c_str(), O_RDONLY);
+        GM_ASSERT(fd >= 0, "InputStream: cannot open " + path);
+        struct stat st;
+        GM_ASSERT(fstat(fd, &st) == 0, "InputStream: cannot stat " + path);
+        mappedBytes = st.st_size;
+        if (mappedBytes > 0) {
+            void *p = mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            GM_ASSERT(p != MAP_FAILED, "InputStream: cannot map " + path);
+            madvise(p, mappedBytes, MADV_SEQUENTIAL);
+            mapped = static_cast<const char *>(p);
+        }
+        close(fd);
+
+        // frame headers give the compressed size, so finding the frames reads no data
+        for (size_t at = 0; at < mappedBytes;) {
+            size_t bytes = ZSTD_findFrameCompressedSize(mapped + at, mappedBytes - at);
+            GM_ASSERT(!ZSTD_isError(bytes), "InputStream: corrupt zstd frame in " + path);
+            frameStart.push_back(at);
+            at += bytes;
+        }
+        frameStart.push_back(mappedBytes);
+        frames = frameStart.size() - 1;
+
+        start(omp_get_max_threads(), [this](size_t f, const Emit &emit) {
+            // one context per decoder thread, reused for all of its frames
+            thread_local unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx *)> dctx{
+                ZSTD_createDCtx(), ZSTD_freeDCtx};
+            size_t t = f % queues.size();
+            ZSTD_inBuffer in{mapped + frameStart[f], frameStart[f + 1] - frameStart[f], 0};
+            size_t remaining = 1; // 0 once the frame is complete
+            while (!stop && remaining != 0) {
+                vector<char> buffer = takeBuffer(t);
+                ZSTD_outBuffer out{buffer.data(), buffer.size(), 0};
+                remaining = ZSTD_decompressStream(dctx.get(), &out, &in);
+                GM_ASSERT(!ZSTD_isError(remaining), "InputStream: corrupt zstd data in " + path);
+                GM_ASSERT(out.pos > 0 || in.pos < in.size || remaining == 0,
+                          "InputStream: truncated zstd frame in " + path);
+                if (out.pos > 0) { emit(buffer, out.pos); }
+            }
+        });
+#else
+        GM_ASSERT(false, "InputStream: built without zstd, cannot read " + path);
+#endif
+    }
+
+    ~Source() {
+        stop = true;
+        for (auto &decoder : decoders) { decoder.join(); }
+        if (mapped) { munmap(const_cast<char *>(mapped), mappedBytes); }
+    }
+};
+
+InputStream::InputStream(const string &path) : source(make_unique<Source>()) {
+    source->path = path;
+    if (endsWith(path, ".gz")) {
+        source->startGzip();
+    } else if (endsWith(path, ".zst")) {
+        source->startZstd();
+    } else {
+        source->startPlain();
+    }
+}
+
+InputStream::~InputStream() = default;
+
+bool InputStream::nextLine(string &line) {
+    line.clear();
+    if (peek() < 0) { return false; }
+    for (int c; (c = peek()) >= 0 && c != '\n'; pos++) { line.push_back(char(c)); }
+    skipLine();
+    if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+    return true;
+}
+
+bool InputStream::refill() {
+    Source &s = *source;
+    while (s.frame < s.frames) {
+        size_t t = s.frame % s.queues.size();
+        Chunk next;
+        while (!s.queues[t]->tryPop(next)) { std::this_thread::yield(); }
+        if (next.endOfFrame) {
+            s.frame++;
+            continue;
+        }
+        // hand the chunk just parsed back to its decoder
+        if (!chunk.empty()) { s.spare[t]->tryPush(chunk); }
+        chunk = std::move(next.data);
+        pos = chunk.data();
+        end = pos + chunk.size();
+        return true;
+    }
+    return false;
+}
+
+} // namespace gm
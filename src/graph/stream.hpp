@@ -0,0 +1,71 @@
+#ifndef GM_STREAM_HPP
+#define GM_STREAM_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gm {
+
+/// Integers of a text file, read in chunks and decompressed on the fly if the path ends in .gz
+/// (zlib) or .zst (zstd). Reading and decompression run on their own threads a few chunks
+/// ahead of the parser, so they overlap with it. The frames of a multi-frame .zst file (pzstd,
+/// or cat of several .zst files) are decompressed in parallel, one frame per thread.
+class InputStream {
+public:
+    explicit InputStream(const std::string &path);
+    ~InputStream();
+    InputStream(const InputStream &) = delete;
+    InputStream &operator=(const InputStream &) = delete;
+
+    /// The next integer, skipping whatever separates it from the last one and the rest of any
+    /// line starting with a comment character. False at the end.
+    bool nextInt(int64_t &value) {
+        int c;
+        while ((c = peek()) >= 0 && (c < '0' || c > '9') && c != '-') {
+            if (c == comment) {
+                skipLine();
+            } else {
+                pos++;
+            }
+        }
+        if (c < 0) { return false; }
+        bool negative = c == '-';
+        if (negative) { pos++; }
+        int64_t x = 0;
+        for (; (c = peek()) >= '0' && c <= '9'; pos++) { x = x * 10 + (c - '0'); }
+        value = negative ? -x : x;
+        return true;
+    }
+    /// Skip to the start of the next line, e.g. past the weight columns of an edge
+    void skipLine() {
+        for (int c; (c = peek()) >= 0;) {
+            pos++;
+            if (c == '\n') { break; }
+        }
+    }
+    /// The rest of the current line, without the newline. False at the end.
+    bool nextLine(std::string &line);
+    /// The next character without consuming it, -1 at the end
+    int peek() {
+        if (pos == end && !refill()) { return -1; }
+        return static_cast<unsigned char>(*pos);
+    }
+
+    /// nextInt skips from this character to the end of the line, -1 for none
+    int comment = -1;
+
+private:
+    struct Source;
+
+    bool refill();
+
+    std::unique_ptr<Source> source;
+    std::vector<char> chunk;
+    const char *pos = nullptr, *end = nullptr;
+};
+
+} // namespace gm
+
+#endif // GM_STREAM_HPP
@@ -0,0 +1,158 @@
+#include "graph/truss.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "alloc.hpp"
+#include "graph/graphv2.hpp"
+#include "graph/types.hpp"
+#include "stats.hpp"
+
+namespace gm {
+
+using namespace std;
+
+namespace {
+
+enum EdgeState : uint8_t { Alive, Frontier, Deleted };
+
+// (smaller endpoint, canonical slot)
+using EdgeRef = pair<v_int, v_int>;
+
+} // namespace
+
+TrussPruner::TrussPruner(v2::Graph &g) : g(g) {
+    PhaseTimer timer{Phase::Truss};
+    v_int slots = g.eSize();
+    support.assign(slots, 0);
+    partner.assign(slots, 0);
+    state.assign(slots, Alive);
+    bytes.update(int64_t(slots) * (2 * sizeof(v_int) + sizeof(uint8_t)));
+
+#pragma omp parallel for schedule(dynamic, 256)
+    for (v_int u = 0; u < g.size(); u++) {
+        for (v_int s = g.off[u]; s < g.off[u + 1]; s++) {
+            v_int v = g.e[s];
+            if (v < u) { continue; }
+            // only this iteration touches the two slots of (u, v)
+            v_int t = std::lower_bound(g.edges(v), g.edgesEnd(v), u) - g.e;
+            partner[s] = t;
+            partner[t] = s;
+            support[s] = g.commonNeighbours(u, v);
+        }
+    }
+}
+
+int64_t TrussPruner::prune(v_int minSupport) {
+    PhaseTimer timer{Phase::Truss};
+    vector<EdgeRef> frontier, next;
+#pragma omp parallel
+    {
+        vector<EdgeRef> local;
+#pragma omp for schedule(dynamic, 256) nowait
+        for (v_int u = 0; u < g.size(); u++) {
+            for (v_int s = g.off[u]; s < g.off[u + 1]; s++) {
+                if (g.e[s] > u && support[s] < minSupport) { local.emplace_back(u, s); }
+            }
+        }
+#pragma omp critical(gm_truss_frontier)
+        frontier.insert(frontier.end(), local.begin(), local.end());
+    }
+
+    // Delete the frontier together. A triangle losing one edge lowers the support of the
+    // other two; losing two, the one with the smaller slot lowers the third; losing all
+    // three, nothing is left to update.
+    int64_t removed = 0;
+    while (!frontier.empty()) {
+        for (auto [u, s] : frontier) { state[s] = Frontier; }
+        next.clear();
+#pragma omp parallel
+        {
+            vector<EdgeRef> local;
+            auto lower = [&](v_int c, v_int from) {
+                v_int old;
+#pragma omp atomic capture
+                old = support[c]--;
+                if (old == minSupport) { local.emplace_back(from, c); }
+            };
+#pragma omp for schedule(dynamic, 64) nowait
+            for (size_t f = 0; f < frontier.size(); f++) {
+                auto [u, s] = frontier[f];
+                v_int v = g.e[s];
+                v_int i = g.off[u], iEnd = g.off[u + 1], j = g.off[v], jEnd = g.off[v + 1];
+                while (i < iEnd && j < jEnd) {
+                    if (g.e[i] < g.e[j]) {
+                        i++;
+                    } else if (g.e[i] > g.e[j]) {
+                        j++;
+                    } else {
+                        v_int w = g.e[i];
+                        v_int cu = canonical(i), cv = canonical(j);
+                        i++;
+                        j++;
+                        if (state[cu] == Deleted || state[cv] == Deleted) { continue; }
+                        bool fu = state[cu] == Frontier, fv = state[cv] == Frontier;
+                        if (!fu && !fv) {
+                            lower(cu, std::min(u, w));
+                            lower(cv, std::min(v, w));
+                        } else if (fu && !fv && s < cu) {
+                            lower(cv, std::min(v, w));
+                        } else if (fv && !fu && s < cv) {
+                            lower(cu, std::min(u, w));
+                        }
+                    }
+                }
+            }
+#pragma omp critical(gm_truss_frontier)
+            next.insert(next.end(), local.begin(), local.end());
+        }
+        for (auto [u, s] : frontier) { state[s] = Deleted; }
+        removed += frontier.size();
+        swap(frontier, next);
+    }
+    if (removed > 0) { compact(); }
+    return removed;
+}
+
+void TrussPruner::compact() {
+    v_int n = g.size();
+    vector<v_int> newSlot(g.eSize());
+    v_int *off = allocArray<v_int>(n + 1);
+    off[0] = 0;
+    for (v_int u = 0; u < n; u++) {
+        v_int degree = 0;
+        for (v_int s = g.off[u]; s < g.off[u + 1]; s++) {
+            newSlot[s] = state[canonical(s)] == Deleted ? -1 : off[u] + degree++;
+        }
+        off[u + 1] = off[u] + degree;
+    }
+
+    v_int slots = off[n];
+    v_int *e = allocArray<v_int>(slots);
+    vector<v_int> newSupport(slots), newPartner(slots);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (v_int u = 0; u < n; u++) {
+        for (v_int s = g.off[u]; s < g.off[u + 1]; s++) {
+            if (newSlot[s] < 0) { continue; }
+            e[newSlot[s]] = g.e[s];
+            newPartner[newSlot[s]] = newSlot[partner[s]];
+            newSupport[newSlot[s]] = support[s];
+        }
+    }
+
+    freeArray(g.off);
+    freeArray(g.e);
+    g.off = off;
+    g.e = e;
+    g.m = slots / 2;
+    support = std::move(newSupport);
+    partner = std::move(newPartner);
+    state.assign(slots, Alive);
+    bytes.update(int64_t(slots) * (2 * sizeof(v_int) + sizeof(uint8_t)));
+    // the rows still have the deleted edges
+    if (g.hubs) { g.buildHubs(g.hubs->threshold()); }
+}
+
+} // namespace gm
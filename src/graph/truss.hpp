@@ -0,0 +1,47 @@
+#ifndef GM_TRUSS_HPP
+#define GM_TRUSS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "graph/graphv2.hpp"
+#include "graph/types.hpp"
+#include "stats.hpp"
+
+namespace gm {
+
+/// Triangle support of every edge, kept up to date while edges are peeled.
+///
+/// An edge of a dense subgraph of size s lies in many triangles inside it, so edges with
+/// support below a model specific threshold can't be in a solution of size s and are
+/// deleted from g, which has to have sorted adjacency lists (e.g. the ranked graph).
+/// Deleting only removes edges, so a solution in the pruned graph is one in g as well.
+class TrussPruner {
+public:
+    static inline bool enabled = true;
+
+    /// Count triangles of every edge, in parallel
+    explicit TrussPruner(v2::Graph &g);
+
+    /// Delete edges with support below minSupport, then the edges that drop below it as a
+    /// result, and compact g. Returns the number of edges deleted.
+    int64_t prune(v_int minSupport);
+
+private:
+    // support and state are indexed by the canonical slot of an edge, the position of the
+    // larger endpoint in the adjacency list of the smaller one
+    v_int canonical(v_int slot) const {
+        return slot < partner[slot] ? slot : partner[slot];
+    }
+    void compact();
+
+    v2::Graph &g;
+    std::vector<v_int> support;
+    std::vector<v_int> partner; // slot of the same edge in the other endpoint's list
+    std::vector<uint8_t> state;
+    TrackedBytes bytes{Memory::Truss};
+};
+
+} // namespace gm
+
+#endif // GM_TRUSS_HPP
@@ -1,6 +1,7 @@
 #ifndef GM_HEAP_CPP
 #define GM_HEAP_CPP
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
@@ -85,6 +86,125 @@ public:
 
 using GraphLinearHeap = LinearHeap<v_id, v_id>;
 
+/// Min-heap over small integer values using array bins (Batagelj-Zaversnik).
+/// Keys are kept in `vert` sorted by value, bucket d starting at `bin[d]`, and keys
+/// before `front` are popped. Values may be decremented below the current minimum.
+/// Storage only grows, so one heap can be reset and reused for many (sub)graphs.
+template<class Key, class Value>
+class BucketHeap {
+private:
+    Key size_ = 0;
+    Key front = 0;
+    std::vector<Key> vert; // keys sorted by value
+    std::vector<Key> pos;  // key -> index in vert
+    std::vector<Value> values;
+    std::vector<Key> bin; // value -> first index of the bucket in vert
+
+    // Move key to the front of its bucket, then shrink the bucket by one,
+    // so key becomes the last element of the bucket below
+    void decrementOne(Key key) {
+        Value d = values[key];
+        if (bin[d] == front) { bin[d - 1] = front; } // new minimum bucket
+        Key first = vert[bin[d]];
+        Key keyPos = pos[key];
+        vert[keyPos] = first;
+        pos[first] = keyPos;
+        vert[bin[d]] = key;
+        pos[key] = bin[d];
+        bin[d]++;
+        values[key] = d - 1;
+    }
+
+public:
+    BucketHeap() {}
+    explicit BucketHeap(const std::vector<Value> &initialValues) {
+        reset(initialValues);
+    }
+
+    /// Re-initialise with new values. Runs in O(size + max value) regardless of the
+    /// capacity left over from earlier use.
+    void reset(const std::vector<Value> &initialValues) {
+        size_ = initialValues.size();
+        front = 0;
+        Value maxVal = 0;
+        for (Value v : initialValues) {
+            if (v > maxVal) { maxVal = v; }
+        }
+        if (vert.size() < size_t(size_)) {
+            vert.resize(size_);
+            pos.resize(size_);
+            values.resize(size_);
+        }
+        if (bin.size() < size_t(maxVal) + 1) { bin.resize(size_t(maxVal) + 1); }
+        std::fill(bin.begin(), bin.begin() + maxVal + 1, 0);
+        // counting sort into bins
+        for (Key i = 0; i < size_; i++) {
+            values[i] = initialValues[i];
+            bin[values[i]]++;
+        }
+        Key start = 0;
+        for (Value d = 0; d <= maxVal; d++) {
+            Key count = bin[d];
+            bin[d] = start;
+            start += count;
+        }
+        for (Key i = 0; i < size_; i++) {
+            pos[i] = bin[values[i]]++;
+            vert[pos[i]] = i;
+        }
+        for (Value d = maxVal; d > 0; d--) { bin[d] = bin[d - 1]; }
+        bin[0] = 0;
+    }
+
+    /// Number of keys not popped yet
+    Key size() const {
+        return size_ - front;
+    }
+    /// Bytes held by the arrays, including capacity left over from earlier use
+    size_t bytes() const {
+        return (vert.capacity() + pos.capacity() + bin.capacity()) * sizeof(Key) +
+               values.capacity() * sizeof(Value);
+    }
+    bool contains(Key key) const {
+        return pos[key] >= front;
+    }
+    Value getById(Key key) const {
+        return values[key];
+    }
+    std::pair<Key, Value> getMin() const {
+        GM_ASSERT(size() > 0, "Size should be >0");
+        return std::make_pair(vert[front], values[vert[front]]);
+    }
+    std::pair<Key, Value> popMin() {
+        GM_ASSERT(size() > 0, "Size should be >0");
+        Key key = vert[front];
+        Value d = values[key];
+        bin[d]++;
+        front++;
+        return std::make_pair(key, d);
+    }
+    bool decrement(Key key, Value amount = 1) {
+        if (!contains(key)) { return false; }
+        for (Value i = 0; i < amount; i++) { decrementOne(key); }
+        return true;
+    }
+    /// Decrement every key in [first, last) by one, skipping popped keys.
+    /// Returns the number of keys decremented.
+    template<class It>
+    Key decrementBatch(It first, It last) {
+        Key count = 0;
+        for (It it = first; it != last; ++it) {
+            if (contains(*it)) {
+                decrementOne(*it);
+                count++;
+            }
+        }
+        return count;
+    }
+};
+
+using GraphBucketHeap = BucketHeap<v_id, v_id>;
+
 } // namespace gm
 
 #endif // GM_HEAP_CPP
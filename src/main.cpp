@@ -1,5 +1,6 @@
 #include <cstddef>
 #include <getopt.h>
+#include <omp.h>
 #include <unistd.h>
 
 #include <chrono>
@@ -7,13 +8,23 @@
 #include <iostream>
 #include <string>
 
+#include "alloc.hpp"
+#include "graph/generate.hpp"
 #include "graph/graphv2.hpp"
 #include "graph/kdefective.hpp"
 #include "graph/kplex.hpp"
 #include "graph/pseudoclique.hpp"
 #include "graph/quasiclique.hpp"
+#include "graph/truss.hpp"
 #include "graph/types.hpp"
+#include "graph/allmodels.hpp"
 #include "graph/convert.hpp"
+#include "graph/densest.hpp"
+#include "graph/egoloop.hpp"
+#include "perf.hpp"
+#include "shard.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
 #include "util.hpp"
 
 using namespace std;
@@ -22,26 +33,176 @@ static const char *USAGE = //
     "Usage:\n"
     "    --help, -h     print help\n"
     "    -p             select program to run\n"
-    "    -g             path to input graph\n"
-    "    -a             algorithm version\n";
+    "    -g             path to input graph: a binary graph directory, or a text edge list with\n"
+    "                   an \"n m\" header, in SNAP format (# comments, any ids) or Matrix Market\n"
+    "                   format; text may be compressed as .gz or .zst\n"
+    "    -a             algorithm version\n"
+    "    --threads      number of threads for the ego network loop\n"
+    "    --stats-json   write per-phase timers, ego network counters and memory use to this file\n"
+    "    --perf-counters  report hardware counters (cycles, instructions, cache, TLB and branch\n"
+    "                   misses) per phase and thread, via perf_event_open\n"
+    "    --trace        write a Chrome trace event timeline of the run to this file\n"
+    "    --trace-min-us only trace ego networks that took at least this long (default 50)\n"
+    "    --no-truss     don't delete edges in too few triangles between ego loop rounds\n"
+    "    --pipeline N   N threads collect and build ego networks, the others solve them\n"
+    "    --hub-degree D also keep the neighbours of vertices of degree >= D as bitmaps, for\n"
+    "                   edge tests and intersections with them (default 0, none)\n"
+    "    --numa         place graph arrays: interleave (over all nodes) or first-touch (by all\n"
+    "                   threads in parallel)\n"
+    "    --huge-pages   back graph arrays with huge pages: thp or explicit (MAP_HUGETLB)\n"
+    "    --solution     write the solution to this file, for -p merge, in the vertex ids of -g\n"
+    "    --shard i/N    only run the ego networks of shard i (from 0) of N\n"
+    "    --bound-file   file the shards share the best solution size through\n"
+    "    --updates      with -p kplex / quasi -a v2 / twohop, apply the batches of edge updates\n"
+    "                   in this file (\"+ u v\" / \"- u v\" lines, blank line between batches)\n"
+    "                   and keep the solution up to date; the result is for the final graph\n"
+    "    --window W     with -p kplex / kdef / quasi, -g is a stream of \"u v t\" edges; solve\n"
+    "                   every window [start, start + W) of it, the result is for the last one\n"
+    "    --slide S      advance the window by S (default W)\n"
+    "\n"
+    "    -p densest -g <graph> [--iterations N] [--epsilon E] [--gap G]\n"
+    "                   near-densest subgraph by N passes of Greedy++ (default 10); a pass peels\n"
+    "                   the vertices within 1 + E of the average load at once (default 0);\n"
+    "                   stops once the upper bound is within 1 + G of the density (default 0)\n"
+    "\n"
+    "    -p all -g <graph> -k K --alpha A\n"
+    "                   kplex and kdef with k, quasi and pseudo with alpha, from the same ego\n"
+    "                   networks in one pass; --solution P writes P.kplex, P.kdef, P.quasi and\n"
+    "                   P.pseudo\n"
+    "\n"
+    "    -p merge -g <graph> [--solution <output>] <solution files>\n"
+    "                   validate the solutions of the shards, which must all be of the same\n"
+    "                   program, k and alpha, and keep the largest (densest for -p densest)\n"
+    "\n"
+    "    -p generate [options] <output dir>\n"
+    "    --model        er, rmat, ba, kplex or quasi (default er)\n"
+    "    -n, -m         number of vertices and edges\n"
+    "    --seed         random seed (default 1)\n"
+    "    --planted      size of the planted k-plex / quasi-clique (-k / --alpha)\n";
 
 constexpr int LONGOPT_ALPHA = 10001;
+constexpr int LONGOPT_THREADS = 10002;
+constexpr int LONGOPT_MODEL = 10003;
+constexpr int LONGOPT_SEED = 10004;
+constexpr int LONGOPT_PLANTED = 10005;
+constexpr int LONGOPT_STATS_JSON = 10006;
+constexpr int LONGOPT_PERF_COUNTERS = 10007;
+constexpr int LONGOPT_TRACE = 10008;
+constexpr int LONGOPT_TRACE_MIN_US = 10009;
+constexpr int LONGOPT_NO_TRUSS = 10010;
+constexpr int LONGOPT_NUMA = 10011;
+constexpr int LONGOPT_HUGE_PAGES = 10012;
+constexpr int LONGOPT_SOLUTION = 10013;
+constexpr int LONGOPT_SHARD = 10014;
+constexpr int LONGOPT_BOUND_FILE = 10015;
+constexpr int LONGOPT_UPDATES = 10016;
+constexpr int LONGOPT_WINDOW = 10017;
+constexpr int LONGOPT_SLIDE = 10018;
+constexpr int LONGOPT_PIPELINE = 10019;
+constexpr int LONGOPT_ITERATIONS = 10020;
+constexpr int LONGOPT_EPSILON = 10021;
+constexpr int LONGOPT_GAP = 10022;
+constexpr int LONGOPT_HUB_DEGREE = 10023;
 static option longopts[] = {
     {"help", no_argument, NULL, 'h'},
     {"program", required_argument, NULL, 'p'},
     {"graph", required_argument, NULL, 'g'},
     {"algorithm", required_argument, NULL, 'a'},
     {"alpha", required_argument, NULL, LONGOPT_ALPHA},
+    {"threads", required_argument, NULL, LONGOPT_THREADS},
+    {"model", required_argument, NULL, LONGOPT_MODEL},
+    {"seed", required_argument, NULL, LONGOPT_SEED},
+    {"planted", required_argument, NULL, LONGOPT_PLANTED},
+    {"stats-json", required_argument, NULL, LONGOPT_STATS_JSON},
+    {"perf-counters", no_argument, NULL, LONGOPT_PERF_COUNTERS},
+    {"trace", required_argument, NULL, LONGOPT_TRACE},
+    {"trace-min-us", required_argument, NULL, LONGOPT_TRACE_MIN_US},
+    {"no-truss", no_argument, NULL, LONGOPT_NO_TRUSS},
+    {"numa", required_argument, NULL, LONGOPT_NUMA},
+    {"huge-pages", required_argument, NULL, LONGOPT_HUGE_PAGES},
+    {"solution", required_argument, NULL, LONGOPT_SOLUTION},
+    {"shard", required_argument, NULL, LONGOPT_SHARD},
+    {"bound-file", required_argument, NULL, LONGOPT_BOUND_FILE},
+    {"updates", required_argument, NULL, LONGOPT_UPDATES},
+    {"window", required_argument, NULL, LONGOPT_WINDOW},
+    {"slide", required_argument, NULL, LONGOPT_SLIDE},
+    {"pipeline", required_argument, NULL, LONGOPT_PIPELINE},
+    {"iterations", required_argument, NULL, LONGOPT_ITERATIONS},
+    {"epsilon", required_argument, NULL, LONGOPT_EPSILON},
+    {"gap", required_argument, NULL, LONGOPT_GAP},
+    {"hub-degree", required_argument, NULL, LONGOPT_HUB_DEGREE},
     {0, 0, 0, 0}, // end of args
 };
 
+// ids of the vertices in the input file, if readFromFile renumbered them
+static vector<int64_t> inputLabels;
+
+static gm::v2::Graph loadGraph(const string &path) {
+    gm::v2::Graph graph = gm::v2::Graph::readFromFile(path, &inputLabels);
+    cout << "[input graph] " << graph << endl;
+    gm::stats().set("n", graph.size());
+    gm::stats().set("m", graph.nEdges());
+    gm::stats().memory(gm::Memory::Graph, graph.bytes());
+    if (gm::HubRows::minDegree > 0) {
+        graph.buildHubs(gm::HubRows::minDegree);
+        cout << "[input graph] hubs=" << graph.hubs->size() << endl;
+    }
+    return graph;
+}
+
+static void saveSolution(const string &path, const gm::SolutionFile &solution) {
+    if (!path.empty()) { gm::writeSolution(path, solution, inputLabels); }
+}
+
+static bool validateSolution(gm::v2::Graph &graph, const gm::SolutionFile &solution) {
+    for (auto v : solution.vertices) {
+        if (v < 0 || v >= graph.size()) { return false; }
+    }
+    if (solution.program == "kplex") {
+        return gm::validateKPlex(graph, solution.vertices, solution.k);
+    }
+    if (solution.program == "kdef") {
+        return gm::checkKDefV2(graph, solution.vertices, solution.k);
+    }
+    if (solution.program == "quasi") {
+        return gm::validateQuasiClique(graph, solution.vertices, solution.alpha);
+    }
+    if (solution.program == "pseudo") {
+        return gm::validatePseudoClique(graph, solution.vertices, solution.alpha);
+    }
+    if (solution.program == "densest") {
+        return gm::validateDensest(graph, solution.vertices, solution.density);
+    }
+    return false;
+}
+
+// Record the outcome, write --stats-json / --trace if requested, and fail on an invalid solution
+static void finish(const string &statsPath, const string &tracePath, size_t solutionSize, bool valid,
+                   const char *error) {
+    gm::stats().set("solution_size", solutionSize);
+    gm::stats().set("valid", valid);
+    gm::Perf::report();
+    if (gm::Stats::enabled) { gm::stats().printMemory(cout); }
+    if (!statsPath.empty()) { gm::stats().writeJson(statsPath); }
+    if (!tracePath.empty()) { gm::trace().writeJson(tracePath); }
+    if (!valid) {
+        cout << error << endl;
+        exit(1);
+    }
+}
+
 int main(int argc, char **argv) {
     int ch, k = 0;
     bool help = false;
-    string program = "kplex", graphPath, algo = "v2";
+    string program = "kplex", graphPath, algo = "v2", statsPath, tracePath, solutionPath,
+           updatesPath;
     double alpha = 0.; // alpha for quasi-clique
+    int64_t window = 0, slide = 0;
+    int iterations = 10;           // passes of -p densest
+    double epsilon = 0., gap = 0.; // batch slack and target gap of -p densest
+    gm::GenerateOptions generate;
 
-    while ((ch = getopt_long(argc, argv, "g:a:p:k:h", longopts, NULL)) != -1) {
+    while ((ch = getopt_long(argc, argv, "g:a:p:k:n:m:h", longopts, NULL)) != -1) {
         // cout << std::format("{} {}\n", char(ch), optarg ? optarg : "");
         switch (ch) {
         case 'h':
@@ -62,37 +223,171 @@ int main(int argc, char **argv) {
         case LONGOPT_ALPHA:
             alpha = strtod(optarg, NULL);
             break;
+        case LONGOPT_THREADS:
+            omp_set_num_threads(strtol(optarg, NULL, 10));
+            break;
+        case 'n':
+            generate.n = strtol(optarg, NULL, 10);
+            break;
+        case 'm':
+            generate.m = strtoll(optarg, NULL, 10);
+            break;
+        case LONGOPT_MODEL:
+            generate.model = optarg;
+            break;
+        case LONGOPT_SEED:
+            generate.seed = strtoull(optarg, NULL, 10);
+            break;
+        case LONGOPT_PLANTED:
+            generate.plantedSize = strtol(optarg, NULL, 10);
+            break;
+        case LONGOPT_STATS_JSON:
+            statsPath = optarg;
+            gm::Stats::enabled = true;
+            break;
+        case LONGOPT_PERF_COUNTERS:
+            gm::Perf::enabled = true;
+            break;
+        case LONGOPT_TRACE:
+            tracePath = optarg;
+            gm::Trace::enabled = true;
+            break;
+        case LONGOPT_TRACE_MIN_US:
+            gm::Trace::minNs = strtoll(optarg, NULL, 10) * 1000;
+            break;
+        case LONGOPT_NO_TRUSS:
+            gm::TrussPruner::enabled = false;
+            break;
+        case LONGOPT_NUMA:
+            GM_ASSERT(string(optarg) == "interleave" || string(optarg) == "first-touch",
+                      "--numa: expected interleave or first-touch");
+            gm::AllocPolicy::placement = string(optarg) == "interleave"
+                                             ? gm::Placement::Interleave
+                                             : gm::Placement::FirstTouch;
+            break;
+        case LONGOPT_HUGE_PAGES:
+            GM_ASSERT(string(optarg) == "thp" || string(optarg) == "explicit",
+                      "--huge-pages: expected thp or explicit");
+            gm::AllocPolicy::hugePages =
+                string(optarg) == "thp" ? gm::HugePages::Transparent : gm::HugePages::Explicit;
+            break;
+        case LONGOPT_SOLUTION:
+            solutionPath = optarg;
+            break;
+        case LONGOPT_SHARD: {
+            int index, count;
+            GM_ASSERT(sscanf(optarg, "%d/%d", &index, &count) == 2 && 0 <= index && index < count,
+                      "--shard: expected i/N with 0 <= i < N");
+            gm::Shard::index = index;
+            gm::Shard::count = count;
+            break;
+        }
+        case LONGOPT_BOUND_FILE:
+            gm::Shard::boundPath = optarg;
+            break;
+        case LONGOPT_UPDATES:
+            updatesPath = optarg;
+            break;
+        case LONGOPT_WINDOW:
+            window = strtoll(optarg, NULL, 10);
+            break;
+        case LONGOPT_SLIDE:
+            slide = strtoll(optarg, NULL, 10);
+            break;
+        case LONGOPT_PIPELINE:
+            gm::EGO_PIPELINE = strtoll(optarg, NULL, 10);
+            break;
+        case LONGOPT_ITERATIONS:
+            iterations = strtol(optarg, NULL, 10);
+            break;
+        case LONGOPT_EPSILON:
+            epsilon = strtod(optarg, NULL);
+            break;
+        case LONGOPT_GAP:
+            gap = strtod(optarg, NULL);
+            break;
+        case LONGOPT_HUB_DEGREE:
+            gm::HubRows::minDegree = strtol(optarg, NULL, 10);
+            break;
         default:
             help = true;
         }
     }
 
+    if (program == "generate" && !help && optind < argc) {
+        if (k > 0) { generate.k = k; }
+        if (alpha > 0) { generate.alpha = alpha; }
+        gm::printTimer([&]() {
+            gm::generateToFile(generate, argv[optind]);
+            return 0;
+        });
+        return 0;
+    }
+
     if (help || graphPath.empty()) {
         cout << USAGE;
         return 0;
     }
 
+    gm::stats().set("program", program);
+    gm::stats().set("algo", algo);
+    gm::stats().set("graph", graphPath);
+    gm::stats().set("k", k);
+    gm::stats().set("alpha", alpha);
+    gm::stats().set("max_threads", omp_get_max_threads());
+    gm::stats().set("shard", gm::Shard::index);
+    gm::stats().set("shard_count", gm::Shard::count);
+
+    if (window > 0 && (program == "kplex" || program == "kdef" || program == "quasi")) {
+        if (program == "quasi" && !(0 < alpha && alpha < 1)) {
+            cout << "ERROR: provide --alpha as a number between 0 and 1" << endl;
+            return 1;
+        }
+        if (slide <= 0) { slide = window; }
+        gm::stats().set("window", window);
+        gm::stats().set("slide", slide);
+        gm::TemporalEdges stream = gm::readTemporalEdges(graphPath);
+        bool twoHop = algo == "twohop";
+        // the last window, to validate the result against
+        gm::v2::Graph graph = gm::v2::Graph::fromEdges(0, {});
+        gm::SolutionFile solution{program, k, alpha, {}};
+        solution.vertices = gm::printTimer([&]() {
+            if (program == "kplex") {
+                return gm::kPlexTemporal(stream, k, twoHop, window, slide, graph);
+            }
+            if (program == "kdef") {
+                return gm::kDefTemporal(stream, k, twoHop, window, slide, graph);
+            }
+            return gm::quasiCliqueTemporal(stream, alpha, twoHop, window, slide, graph);
+        });
+        cout << "[temporal] Result size = " << solution.vertices.size() << endl;
+        saveSolution(solutionPath, solution);
+        finish(statsPath, tracePath, solution.vertices.size(), validateSolution(graph, solution),
+               "ERROR: !!!!!!Invalid solution of the last window!!!!!!");
+        return 0;
+    }
+
     if (program == "kplex") {
-        gm::v2::Graph graph = gm::v2::Graph::readFromFile(graphPath);
-        cout << "[input graph] " << graph << endl;
+        gm::v2::Graph graph = loadGraph(graphPath);
         gm::KPlexDegenResult result;
-        auto start = chrono::high_resolution_clock::now();
-        if (algo == "naive") {
-            result = gm::kPlexDegen(graph, k);
+        if (!updatesPath.empty() && algo != "naive") {
+            result = gm::printTimer(
+                [&]() { return gm::kPlexDynamic(graph, k, algo == "twohop", updatesPath); });
+            cout << "[kPlexDynamic] Result size = " << result.kPlex.size() << endl;
+        } else if (algo == "naive") {
+            result = gm::printTimer([&]() { return gm::kPlexDegen(graph, k); });
             cout << "[kPlexDegen] Result size = " << result.kPlex.size() << "\n"
                  << "    upper bound: " << result.ub << endl;
         } else if (algo == "v2") {
-            result = gm::kPlexV2(graph, k, false);
+            result = gm::printTimer([&]() { return gm::kPlexV2(graph, k, false); });
             cout << "[kPlexV2] Result size = " << result.kPlex.size() << "\n"
                  << "    upper bound: " << result.ub << endl;
         } else {
-            result = gm::kPlexV2(graph, k, true);
+            result = gm::printTimer([&]() { return gm::kPlexV2(graph, k, true); });
             cout << "[kPlexTwoHop] Result size = " << result.kPlex.size() << "\n"
                  << "    upper bound: " << result.ub << endl;
         }
-        auto end = chrono::high_resolution_clock::now();
-        cout << "[timer] " << chrono::duration_cast<chrono::microseconds>(end - start).count()
-             << " microseconds" << endl;
+        gm::stats().set("upper_bound", result.ub);
         cout << "[solution] ";
         // comment when experimenting
         // for (auto it = result.kPlex.begin(); it < result.kPlex.end(); it++) {
@@ -103,56 +398,50 @@ int main(int argc, char **argv) {
         //     }
         // }
         cout << endl;
-        if (!gm::validateKPlex(graph, result.kPlex, k)) {
-            cout << "ERROR: !!!!!!Invalid kplex!!!!!!" << endl;
-            exit(1);
-        }
+        saveSolution(solutionPath, {program, k, alpha, result.kPlex});
+        finish(statsPath, tracePath, result.kPlex.size(), gm::validateKPlex(graph, result.kPlex, k),
+               "ERROR: !!!!!!Invalid kplex!!!!!!");
     } else if (program == "kdef") {
-        gm::v2::Graph graph = gm::v2::Graph::readFromFile(graphPath);
-        cout << "[input graph] " << graph << endl;
+        gm::v2::Graph graph = loadGraph(graphPath);
         if (algo == "twohop") { cout << "[kDef] using 2-hop neighbours\n"; }
         if (algo == "naive") { cout << "[kDef] using naive algo\n"; }
-        auto start = chrono::high_resolution_clock::now();
         gm::kDefResult result;
         if (algo == "naive") {
-            result = gm::kDefNaiveV2(graph, k);
+            result = gm::printTimer([&]() { return gm::kDefNaiveV2(graph, k); });
         } else {
-            result = gm::kDefDegenV2(graph, k, algo == "twohop");
+            result = gm::printTimer([&]() { return gm::kDefDegenV2(graph, k, algo == "twohop"); });
         }
         cout << "[kDef] Result size = " << result.size << endl;
-        auto end = chrono::high_resolution_clock::now();
-        cout << "[timer] " << chrono::duration_cast<chrono::microseconds>(end - start).count()
-             << " microseconds" << endl;
-        if (!gm::checkKDefV2(graph, result.kDefective, k)) {
-            cout << "ERROR: !!!!!!Invalid k-defective-clique!!!!!!" << endl;
-            exit(1);
-        }
+        saveSolution(solutionPath, {program, k, alpha, result.kDefective});
+        finish(statsPath, tracePath, result.size, gm::checkKDefV2(graph, result.kDefective, k),
+               "ERROR: !!!!!!Invalid k-defective-clique!!!!!!");
     } else if (program == "quasi") {
         if (!(0 < alpha && alpha < 1)) {
             cout << "ERROR: provide --alpha as a number between 0 and 1" << endl;
             exit(1);
         }
-        gm::v2::Graph graph = gm::v2::Graph::readFromFile(graphPath);
-        cout << "[input graph] " << graph << endl;
+        gm::v2::Graph graph = loadGraph(graphPath);
         cout << format("[quasiClique] alpha={}\n", alpha);
         gm::SubgraphResult result;
-        if (algo == "naive") {
+        if (!updatesPath.empty() && algo != "naive") {
+            result = gm::printTimer([&]() {
+                return gm::quasiCliqueDynamic(graph, alpha, algo == "twohop", updatesPath);
+            });
+        } else if (algo == "naive") {
             result = gm::printTimer([&]() { return gm::quasiCliqueNaive(graph, alpha); });
         } else {
             result = gm::printTimer([&]() { return gm::quasiClique(graph, alpha, algo == "twohop"); });
         }
         cout << format("[quasiClique] Result size = {}\n", result.size);
-        if (!gm::validateQuasiClique(graph, result.subgraph, alpha)) {
-            cout << "ERROR: !!!!!!Invalid quasiclique!!!!!!" << endl;
-            exit(1);
-        }
+        saveSolution(solutionPath, {program, k, alpha, result.subgraph});
+        finish(statsPath, tracePath, result.size,
+               gm::validateQuasiClique(graph, result.subgraph, alpha), "ERROR: !!!!!!Invalid quasiclique!!!!!!");
     } else if (program == "pseudo") {
         if (!(0 < alpha && alpha < 1)) {
             cout << "ERROR: provide --alpha as a number between 0 and 1" << endl;
             exit(1);
         }
-        gm::v2::Graph graph = gm::v2::Graph::readFromFile(graphPath);
-        cout << "[input graph] " << graph << endl;
+        gm::v2::Graph graph = loadGraph(graphPath);
         cout << format("[pseudoClique] alpha={}\n", alpha);
         gm::SubgraphResult result;
         if (algo == "naive") {
@@ -161,10 +450,85 @@ int main(int argc, char **argv) {
             result = gm::printTimer([&]() { return gm::pseudoClique(graph, alpha, algo == "twohop"); });
         }
         cout << format("[pseudoClique] Result size = {}\n", result.size);
-        if (!gm::validatePseudoClique(graph, result.subgraph, alpha)) {
-            cout << "ERROR: !!!!!!Invalid pseudoclique!!!!!!" << endl;
+        saveSolution(solutionPath, {program, k, alpha, result.subgraph});
+        finish(statsPath, tracePath, result.size,
+               gm::validatePseudoClique(graph, result.subgraph, alpha), "ERROR: !!!!!!Invalid pseudoclique!!!!!!");
+    } else if (program == "all") {
+        if (!(0 < alpha && alpha < 1)) {
+            cout << "ERROR: provide --alpha as a number between 0 and 1" << endl;
             exit(1);
         }
+        GM_ASSERT(algo == "v2" || algo == "twohop", "-p all: expected -a v2 or twohop");
+        GM_ASSERT(updatesPath.empty() && window == 0 && gm::Shard::boundPath.empty(),
+                  "-p all: --updates, --window and --bound-file need a single program");
+        gm::v2::Graph graph = loadGraph(graphPath);
+        cout << format("[all] k={} alpha={}\n", k, alpha);
+        gm::AllModelsResult result =
+            gm::printTimer([&]() { return gm::allModels(graph, k, alpha, algo == "twohop"); });
+        const gm::SolutionFile solutions[] = {
+            {"kplex", k, alpha, result.kPlex.kPlex},
+            {"kdef", k, alpha, result.kDef.kDefective},
+            {"quasi", k, alpha, result.quasiClique.subgraph},
+            {"pseudo", k, alpha, result.pseudoClique.subgraph},
+        };
+        bool valid = true;
+        size_t total = 0;
+        for (const gm::SolutionFile &solution : solutions) {
+            bool solutionValid = validateSolution(graph, solution);
+            cout << format("[all] {} Result size = {}{}\n", solution.program,
+                           solution.vertices.size(), solutionValid ? "" : " (invalid)");
+            gm::stats().set("solution_size_" + solution.program, solution.vertices.size());
+            if (!solutionPath.empty()) {
+                saveSolution(solutionPath + "." + solution.program, solution);
+            }
+            valid = valid && solutionValid;
+            total += solution.vertices.size();
+        }
+        // solution_size is the sum, the size of each is in solution_size_<program>
+        finish(statsPath, tracePath, total, valid, "ERROR: !!!!!!Invalid solution!!!!!!");
+    } else if (program == "densest") {
+        gm::v2::Graph graph = loadGraph(graphPath);
+        cout << format("[densest] iterations={} epsilon={} gap={}\n", iterations, epsilon, gap);
+        gm::DensestResult result = gm::printTimer(
+            [&]() { return gm::densestSubgraph(graph, iterations, epsilon, gap); });
+        cout << format("[densest] Result size = {} density = {:.6f}\n", result.subgraph.size(),
+                       result.density);
+        saveSolution(solutionPath, {program, k, alpha, result.subgraph, result.density});
+        finish(statsPath, tracePath, result.subgraph.size(),
+               gm::validateDensest(graph, result.subgraph, result.density),
+               "ERROR: !!!!!!Subgraph less dense than reported!!!!!!");
+    } else if (program == "merge") {
+        gm::v2::Graph graph = loadGraph(graphPath);
+        gm::SolutionFile best;
+        bool found = false;
+        for (int i = optind; i < argc; i++) {
+            gm::SolutionFile shard = gm::readSolution(argv[i], inputLabels);
+            // shards of different programs or parameters don't compete
+            if (i == optind) {
+                best.program = shard.program;
+                best.k = shard.k;
+                best.alpha = shard.alpha;
+            }
+            GM_ASSERT(shard.program == best.program && shard.k == best.k &&
+                          shard.alpha == best.alpha,
+                      format("-p merge: {} is {} k={} alpha={}, not {} k={} alpha={}", argv[i],
+                             shard.program, shard.k, shard.alpha, best.program, best.k,
+                             best.alpha));
+            bool valid = validateSolution(graph, shard);
+            cout << format("[merge] {}: {} size={} {}\n", argv[i], shard.program,
+                           shard.vertices.size(), valid ? "valid" : "INVALID");
+            // densest subgraphs compete on density, the others on size
+            bool better = shard.program == "densest" ? shard.density > best.density
+                                                     : shard.vertices.size() > best.vertices.size();
+            if (valid && (!found || better)) {
+                best = std::move(shard);
+                found = true;
+            }
+        }
+        cout << format("[merge] Result size = {}\n", best.vertices.size());
+        saveSolution(solutionPath, best);
+        finish(statsPath, tracePath, best.vertices.size(), found,
+               "ERROR: no valid solution to merge");
     } else if (program == "convert") {
         gm::convertGraph(graphPath, argv[optind]);
     }
@@ -0,0 +1,229 @@
+#include "perf.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "stats.hpp"
+
+namespace gm {
+
+using namespace std;
+
+namespace {
+
+constexpr size_t EVENTS = size_t(PerfEvent::Count);
+constexpr size_t PHASES = size_t(PerfPhase::Count);
+
+const char *EVENT_NAMES[] = {"cycles", "instructions", "llc_misses", "dtlb_misses", "branch_misses"};
+const char *PHASE_NAMES[] = {"load", "peel", "ego_loop", "validate"};
+
+perf_event_attr eventAttr(PerfEvent event) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    auto cache = [](uint64_t id, uint64_t op, uint64_t result) {
+        return id | (op << 8) | (result << 16);
+    };
+    switch (event) {
+    case PerfEvent::Cycles:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PerfEvent::Instructions:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PerfEvent::LLCMisses:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case PerfEvent::DTLBMisses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                            PERF_COUNT_HW_CACHE_RESULT_MISS);
+        break;
+    case PerfEvent::BranchMisses:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    default:
+        break;
+    }
+    return attr;
+}
+
+/// One event group per thread, opened on the thread's first PerfScope
+struct PerfGroup {
+    int leader = -1;
+    array<int, EVENTS> fds;
+    array<uint64_t, EVENTS> ids{};
+    PerfThreadCounts *counts = nullptr;
+
+    PerfGroup() {
+        fds.fill(-1);
+    }
+    ~PerfGroup() {
+        for (int fd : fds) {
+            if (fd >= 0) { close(fd); }
+        }
+    }
+    bool ok() const {
+        return leader >= 0;
+    }
+
+    /// Current values scaled for multiplexing, -1 for events that aren't counted
+    array<int64_t, EVENTS> read() const {
+        array<int64_t, EVENTS> values;
+        values.fill(-1);
+        // nr, time_enabled, time_running, then {value, id} per event
+        uint64_t buf[3 + 2 * EVENTS];
+        if (::read(leader, buf, sizeof(buf)) < ssize_t(3 * sizeof(uint64_t))) { return values; }
+        uint64_t nr = buf[0], enabled = buf[1], running = buf[2];
+        double scale = running == 0 ? 0.0 : double(enabled) / double(running);
+        for (uint64_t i = 0; i < nr && i < EVENTS; i++) {
+            uint64_t value = buf[3 + 2 * i], id = buf[4 + 2 * i];
+            for (size_t e = 0; e < EVENTS; e++) {
+                if (fds[e] >= 0 && ids[e] == id) { values[e] = int64_t(double(value) * scale); }
+            }
+        }
+        return values;
+    }
+};
+
+mutex registryMutex;
+vector<unique_ptr<PerfThreadCounts>> registry;
+atomic<bool> warned = false;
+
+PerfGroup &localGroup() {
+    thread_local PerfGroup group = [] {
+        PerfGroup g;
+        int lastErrno = 0;
+        for (size_t e = 0; e < EVENTS; e++) {
+            perf_event_attr attr = eventAttr(PerfEvent(e));
+            int fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, g.leader, 0));
+            if (fd < 0) {
+                lastErrno = errno;
+                continue;
+            }
+            if (g.leader < 0) { g.leader = fd; }
+            g.fds[e] = fd;
+            ioctl(fd, PERF_EVENT_IOC_ID, &g.ids[e]);
+        }
+        if (!g.ok()) {
+            if (!warned.exchange(true)) {
+                cerr << format("[perf] warning: perf_event_open failed ({}), hardware counters disabled. "
+                               "Check /proc/sys/kernel/perf_event_paranoid\n",
+                               strerror(lastErrno));
+            }
+            return g;
+        }
+        lock_guard lock{registryMutex};
+        registry.push_back(make_unique<PerfThreadCounts>());
+        g.counts = registry.back().get();
+        g.counts->tid = int(syscall(SYS_gettid));
+        for (auto &phase : g.counts->values) { phase.fill(0); }
+        return g;
+    }();
+    return group;
+}
+
+thread_local array<int64_t, EVENTS> scopeStart;
+
+} // namespace
+
+PerfScope::PerfScope(PerfPhase phase) : phase(phase) {
+    if (!Perf::enabled) { return; }
+    PerfGroup &group = localGroup();
+    if (!group.ok()) { return; }
+    running = true;
+    scopeStart = group.read();
+}
+
+PerfScope::~PerfScope() {
+    if (!running) { return; }
+    PerfGroup &group = localGroup();
+    array<int64_t, EVENTS> end = group.read();
+    auto &values = group.counts->values[size_t(phase)];
+    for (size_t e = 0; e < EVENTS; e++) {
+        if (end[e] < 0 || scopeStart[e] < 0) {
+            values[e] = -1;
+        } else if (values[e] >= 0) {
+            values[e] += end[e] - scopeStart[e];
+        }
+    }
+    group.counts->seen[size_t(phase)] = true;
+}
+
+void Perf::report() {
+    if (!enabled) { return; }
+    lock_guard lock{registryMutex};
+    if (registry.empty()) { return; }
+
+    auto formatRow = [](const array<int64_t, EVENTS> &values) {
+        string row;
+        for (int64_t v : values) { row += v < 0 ? format(" {}", "-") : format(" {}", v); }
+        if (values[0] > 0 && values[1] >= 0) {
+            row += format(" ipc={:.2f}", double(values[1]) / values[0]);
+        }
+        return row;
+    };
+
+    // -1 means the event could not be counted
+    auto eventsJson = [](const array<int64_t, EVENTS> &values) {
+        string out;
+        for (size_t e = 0; e < EVENTS; e++) {
+            out += format("{}\"{}\": {}", e ? ", " : "", EVENT_NAMES[e], values[e]);
+        }
+        return out;
+    };
+
+    string header;
+    for (const char *name : EVENT_NAMES) { header += format(" {}", name); }
+    cout << "[perf] phase thread" << header << "\n";
+
+    string json = "{";
+    for (size_t p = 0; p < PHASES; p++) {
+        array<int64_t, EVENTS> total{};
+        bool any = false;
+        string threadsJson;
+        for (const auto &thread : registry) {
+            if (!thread->seen[p]) { continue; }
+            const auto &values = thread->values[p];
+            for (size_t e = 0; e < EVENTS; e++) {
+                total[e] = (values[e] < 0 || total[e] < 0) ? -1 : total[e] + values[e];
+            }
+            if (registry.size() > 1) {
+                cout << format("[perf] {} {}", PHASE_NAMES[p], thread->tid) << formatRow(values) << "\n";
+            }
+            threadsJson += string(any ? ", " : "") + "{\"tid\": " + to_string(thread->tid) + ", " +
+                           eventsJson(values) + "}";
+            any = true;
+        }
+        if (!any) { continue; }
+        cout << format("[perf] {} total", PHASE_NAMES[p]) << formatRow(total) << "\n";
+
+        json += format("{}\"{}\": ", json.size() > 1 ? ", " : "", PHASE_NAMES[p]);
+        json += "{\"total\": {" + eventsJson(total) + "}, \"threads\": [" + threadsJson + "]}";
+    }
+    json += "}";
+    stats().setJson("perf", json);
+}
+
+} // namespace gm
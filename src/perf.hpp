@@ -0,0 +1,49 @@
+#ifndef GM_PERF_HPP
+#define GM_PERF_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace gm {
+
+enum class PerfPhase { Load, Peel, EgoLoop, Validate, Count };
+
+enum class PerfEvent { Cycles, Instructions, LLCMisses, DTLBMisses, BranchMisses, Count };
+
+/// Hardware counters of one thread, per phase. -1 if the event could not be opened.
+struct PerfThreadCounts {
+    int tid = 0;
+    std::array<std::array<int64_t, std::size_t(PerfEvent::Count)>, std::size_t(PerfPhase::Count)>
+        values{};
+    std::array<bool, std::size_t(PerfPhase::Count)> seen{};
+};
+
+/// Opt-in hardware performance counters (--perf-counters), read through perf_event_open.
+/// Each thread opens one event group for itself, counting user space only, so it works
+/// without root when perf_event_paranoid <= 2. Events the host doesn't support are
+/// reported as missing; if nothing can be opened a warning is printed once.
+class Perf {
+public:
+    static inline bool enabled = false;
+
+    /// Print per thread and aggregate counts, and add them to --stats-json
+    static void report();
+};
+
+/// Counts the calling thread's events from construction to destruction into a phase
+class PerfScope {
+public:
+    explicit PerfScope(PerfPhase phase);
+    ~PerfScope();
+    PerfScope(const PerfScope &) = delete;
+    PerfScope &operator=(const PerfScope &) = delete;
+
+private:
+    PerfPhase phase;
+    bool running = false;
+};
+
+} // namespace gm
+
+#endif // GM_PERF_HPP
@@ -0,0 +1,84 @@
+#ifndef GM_QUEUE_HPP
+#define GM_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace gm {
+
+/// Bounded multi-producer multi-consumer queue without locks (Vyukov's ring buffer). Every
+/// cell carries a sequence number telling whether it is free for the push of a lap or full
+/// for its pop, so producers and consumers only contend on their own end of the ring.
+template<class T>
+class BoundedQueue {
+public:
+    /// Capacity is rounded up to a power of two
+    explicit BoundedQueue(size_t capacity)
+        : mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+          cells(std::make_unique<Cell[]>(mask + 1)) {
+        for (size_t i = 0; i <= mask; i++) { cells[i].sequence.store(i); }
+    }
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    /// Moves value in and returns true, or returns false if the queue is full
+    bool tryPush(T &value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = std::ptrdiff_t(sequence) - std::ptrdiff_t(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Moves the oldest element out and returns true, or returns false if the queue is empty
+    bool tryPop(T &value) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = std::ptrdiff_t(sequence) - std::ptrdiff_t(pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+} // namespace gm
+
+#endif // GM_QUEUE_HPP
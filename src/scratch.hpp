@@ -0,0 +1,107 @@
+#ifndef GM_SCRATCH_HPP
+#define GM_SCRATCH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "graph/types.hpp"
+
+namespace gm {
+
+/// Set of vertex ids that clears in O(1): an id is in the set iff its stamp is the current
+/// epoch. The stamps are only zeroed when the epoch wraps around, once every 65535 clears.
+template<class Stamp = uint16_t>
+class EpochMarks {
+public:
+    /// Make room for ids below n, keeping the contents
+    void resize(size_t n) {
+        if (stamp.size() < n) { stamp.resize(n, 0); }
+    }
+    void clear() {
+        if (++epoch == 0) {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+    }
+    void insert(v_int v) {
+        stamp[v] = epoch;
+    }
+    void erase(v_int v) {
+        stamp[v] = 0;
+    }
+    bool contains(v_int v) const {
+        return stamp[v] == epoch;
+    }
+    int64_t bytes() const {
+        return stamp.capacity() * sizeof(Stamp);
+    }
+
+private:
+    std::vector<Stamp> stamp;
+    Stamp epoch = 1;
+};
+
+/// Map from vertex ids to values that clears in O(1), the same way as EpochMarks
+template<class Value, class Stamp = uint16_t>
+class EpochMap {
+public:
+    void resize(size_t n) {
+        marks.resize(n);
+        if (values.size() < n) { values.resize(n); }
+    }
+    void clear() {
+        marks.clear();
+    }
+    void set(v_int v, Value value) {
+        marks.insert(v);
+        values[v] = value;
+    }
+    /// The value of v, or missing if v isn't in the map
+    Value get(v_int v, Value missing) const {
+        return marks.contains(v) ? values[v] : missing;
+    }
+    int64_t bytes() const {
+        return marks.bytes() + values.capacity() * sizeof(Value);
+    }
+
+private:
+    EpochMarks<Stamp> marks;
+    std::vector<Value> values;
+};
+
+/// Per thread buffers reused by the solvers and validators, so none of them allocates or
+/// clears an array of size n for each ego network or call. A member is only used by one
+/// function at a time; functions that call each other use different members.
+struct Scratch {
+    EpochMarks<> included;    // candidates of the ego network being collected
+    EpochMap<v_int> position; // vertex id -> id in the subgraph being built
+    EpochMarks<> members;     // the solution a naive kernel grows, or a validator checks
+    std::vector<v_int> sorted; // a solution sorted by id, for validation
+
+    int64_t bytes() const {
+        return included.bytes() + position.bytes() + members.bytes() +
+               sorted.capacity() * sizeof(v_int);
+    }
+};
+
+inline Scratch &scratch() {
+    static thread_local Scratch instance;
+    return instance;
+}
+
+/// The vertices of a solution sorted by id, in the sorted buffer of this thread. Validators
+/// intersect it with the (sorted) neighbours of each vertex instead of marking the solution
+/// in an array of size n.
+inline std::vector<v_int> &sortedSolution(const std::vector<v_id> &solution) {
+    std::vector<v_int> &sorted = scratch().sorted;
+    sorted.assign(solution.begin(), solution.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+} // namespace gm
+
+#endif // GM_SCRATCH_HPP
@@ -0,0 +1,77 @@
+#include "shard.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "util.hpp"
+
+namespace gm {
+
+using namespace std;
+
+v_int Shard::exchangeBound(v_int size) {
+    int fd = open(boundPath.c_str(), O_RDWR | O_CREAT, 0644);
+    GM_ASSERT(fd >= 0, "Shard::exchangeBound: cannot open " + boundPath);
+    flock(fd, LOCK_EX);
+    char buffer[32] = {};
+    ssize_t length = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    v_int shared = length > 0 ? strtol(buffer, NULL, 10) : 0;
+    if (size > shared) {
+        string text = format("{}\n", size);
+        bool written = ftruncate(fd, 0) == 0 &&
+                       pwrite(fd, text.data(), text.size(), 0) == ssize_t(text.size());
+        GM_ASSERT(written, "Shard::exchangeBound: cannot write " + boundPath);
+        shared = size;
+    }
+    close(fd);
+    return shared;
+}
+
+void writeSolution(const string &path, const SolutionFile &solution,
+                   const vector<int64_t> &labels) {
+    ofstream out{path};
+    GM_ASSERT(out, "writeSolution: cannot open " + path);
+    // shortest representation that reads back exactly, e.g. the density of -p densest
+    out << format("{} {} {} {}\n", solution.program, solution.k, solution.alpha, solution.density);
+    for (size_t i = 0; i < solution.vertices.size(); i++) {
+        v_id v = solution.vertices[i];
+        out << (i ? " " : "");
+        if (labels.empty()) {
+            out << v;
+        } else {
+            out << labels[v];
+        }
+    }
+    out << "\n";
+}
+
+SolutionFile readSolution(const string &path, const vector<int64_t> &labels) {
+    ifstream in{path};
+    GM_ASSERT(in, "readSolution: cannot open " + path);
+    SolutionFile solution;
+    string line;
+    std::getline(in, line);
+    istringstream header{line};
+    GM_ASSERT(header >> solution.program >> solution.k >> solution.alpha,
+              "readSolution: bad header in " + path);
+    // files written before the density field have three
+    if (!(header >> solution.density)) { solution.density = 0.; }
+    for (int64_t v; in >> v;) {
+        if (!labels.empty()) {
+            auto it = std::lower_bound(labels.begin(), labels.end(), v);
+            v = it != labels.end() && *it == v ? it - labels.begin() : -1;
+        }
+        solution.vertices.push_back(v);
+    }
+    return solution;
+}
+
+} // namespace gm
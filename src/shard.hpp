@@ -0,0 +1,47 @@
+#ifndef GM_SHARD_HPP
+#define GM_SHARD_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "graph/types.hpp"
+
+namespace gm {
+
+/// Which roots of the ego loop this process runs (--shard i/N) and the file it shares its
+/// incumbent size through with the other shards (--bound-file). Roots are dealt to shards in
+/// chunks of CHUNK consecutive roots of the ego loop, round robin.
+struct Shard {
+    static constexpr v_int CHUNK = 64;
+    static inline v_int index = 0;
+    static inline v_int count = 1;
+    static inline std::string boundPath;
+
+    static bool owns(v_id root) {
+        return count == 1 || (root / CHUNK) % count == index;
+    }
+    /// Raise the bound in the file to size if it is larger, and return the bound in the file.
+    /// The file is locked, so any number of processes can share it.
+    static v_int exchangeBound(v_int size);
+};
+
+/// A solution as written by --solution: the program and parameters it was found with, and
+/// its vertices in input graph ids
+struct SolutionFile {
+    std::string program;
+    v_int k = 0;
+    double alpha = 0.;
+    std::vector<v_id> vertices;
+    double density = 0.; // of -p densest, which competes on it rather than on size
+};
+
+/// labels are the ids of the input file (see readFromFile); if given, the vertices are written
+/// as labels and read back by their position in labels, -1 if they're not in it
+void writeSolution(const std::string &path, const SolutionFile &solution,
+                   const std::vector<int64_t> &labels = {});
+SolutionFile readSolution(const std::string &path, const std::vector<int64_t> &labels = {});
+
+} // namespace gm
+
+#endif // GM_SHARD_HPP
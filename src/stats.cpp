@@ -0,0 +1,133 @@
+#include "stats.hpp"
+
+#include <sys/resource.h>
+
+#include <format>
+#include <fstream>
+#include <string>
+
+#include "util.hpp"
+
+namespace gm {
+
+static const char *PHASE_NAMES[] = {
+    "load", "peel", "rank_sort", "truss", "collect", "build", "bound", "solve", "validate",
+};
+static const char *COUNTER_NAMES[] = {
+    "visited", "pruned_degree", "pruned_size", "pruned_bound", "solved", "improved", "cancelled",
+};
+static const char *MEMORY_NAMES[] = {
+    "graph", "load_buffer", "peel", "truss", "ego_scratch", "subgraph_scratch", "subgraph",
+    "hubs",
+};
+
+static std::string jsonString(const std::string &s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out += '\\'; }
+        out += c;
+    }
+    return out + "\"";
+}
+
+const char *phaseName(Phase phase) {
+    return PHASE_NAMES[size_t(phase)];
+}
+
+Stats &stats() {
+    static Stats instance;
+    return instance;
+}
+
+int64_t peakRss() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return int64_t(usage.ru_maxrss) * 1024;
+}
+
+// Per thread peaks are summed: the worst case if every thread peaks at the same time
+static std::array<int64_t, size_t(Memory::Count)>
+memoryPeaks(const std::vector<std::unique_ptr<ThreadStats>> &threads) {
+    std::array<int64_t, size_t(Memory::Count)> peaks{};
+    for (const auto &thread : threads) {
+        for (size_t i = 0; i < peaks.size(); i++) { peaks[i] += thread->memPeak[i]; }
+    }
+    return peaks;
+}
+
+void Stats::printMemory(std::ostream &os) {
+    std::lock_guard lock{mutex};
+    auto peaks = memoryPeaks(threads);
+    for (size_t i = 0; i < peaks.size(); i++) {
+        os << std::format("[memory] {}: {:.2f} MiB\n", MEMORY_NAMES[i], peaks[i] / 1048576.0);
+    }
+    os << std::format("[memory] peak RSS: {:.2f} MiB\n", peakRss() / 1048576.0);
+}
+
+ThreadStats *Stats::registerThread() {
+    std::lock_guard lock{mutex};
+    threads.push_back(std::make_unique<ThreadStats>());
+    return threads.back().get();
+}
+
+void Stats::setRaw(const std::string &key, std::string encoded) {
+    std::lock_guard lock{mutex};
+    for (auto &field : fields) {
+        if (field.first == key) {
+            field.second = std::move(encoded);
+            return;
+        }
+    }
+    fields.emplace_back(key, std::move(encoded));
+}
+void Stats::set(const std::string &key, double value) {
+    setRaw(key, std::format("{}", value));
+}
+void Stats::set(const std::string &key, bool value) {
+    setRaw(key, value ? "true" : "false");
+}
+void Stats::set(const std::string &key, const std::string &value) {
+    setRaw(key, jsonString(value));
+}
+
+void Stats::writeJson(const std::string &path) {
+    ThreadStats total;
+    for (const auto &thread : threads) {
+        for (size_t i = 0; i < total.phaseNs.size(); i++) { total.phaseNs[i] += thread->phaseNs[i]; }
+        for (size_t i = 0; i < total.counters.size(); i++) { total.counters[i] += thread->counters[i]; }
+        for (size_t i = 0; i < total.egoSizes.size(); i++) { total.egoSizes[i] += thread->egoSizes[i]; }
+    }
+
+    std::ofstream out{path};
+    GM_ASSERT(out, "Stats::writeJson: cannot open " + path);
+    out << "{\n";
+    for (const auto &[key, value] : fields) { out << "  " << jsonString(key) << ": " << value << ",\n"; }
+    out << "  \"threads\": " << threads.size() << ",\n";
+    // phase times summed over threads, so ego loop phases count CPU time
+    out << "  \"phases_us\": {";
+    for (size_t i = 0; i < total.phaseNs.size(); i++) {
+        out << (i ? ", " : "") << jsonString(PHASE_NAMES[i]) << ": " << total.phaseNs[i] / 1000;
+    }
+    out << "},\n  \"ego\": {";
+    for (size_t i = 0; i < total.counters.size(); i++) {
+        out << (i ? ", " : "") << jsonString(COUNTER_NAMES[i]) << ": " << total.counters[i];
+    }
+    out << "},\n  \"ego_size_histogram\": [";
+    bool first = true;
+    for (size_t i = 0; i < total.egoSizes.size(); i++) {
+        if (total.egoSizes[i] == 0) { continue; }
+        int64_t lo = i == 0 ? 0 : int64_t(1) << (i - 1);
+        int64_t hi = i == 0 ? 0 : (int64_t(1) << i) - 1;
+        out << (first ? "" : ", ") << "{\"min\": " << lo << ", \"max\": " << hi
+            << ", \"count\": " << total.egoSizes[i] << "}";
+        first = false;
+    }
+    out << "],\n  \"memory_peak_bytes\": {";
+    auto peaks = memoryPeaks(threads);
+    for (size_t i = 0; i < peaks.size(); i++) {
+        out << (i ? ", " : "") << jsonString(MEMORY_NAMES[i]) << ": " << peaks[i];
+    }
+    out << "},\n  \"peak_rss_bytes\": " << peakRss() << "\n}\n";
+}
+
+} // namespace gm
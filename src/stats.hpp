@@ -0,0 +1,179 @@
+#ifndef GM_STATS_HPP
+#define GM_STATS_HPP
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "trace.hpp"
+
+namespace gm {
+
+enum class Phase { Load, Peel, RankSort, Truss, Collect, Build, Bound, Solve, Validate, Count };
+
+const char *phaseName(Phase phase);
+
+enum class Counter {
+    EgoVisited,      // roots looked at by the ego loop
+    EgoPrunedDegree, // root skipped by the degree test
+    EgoPrunedSize,   // candidates collected, but not more than the incumbent
+    EgoPrunedBound,  // subgraph built, but its upper bound is not more than the incumbent
+    EgoSolved,       // subgraph built and the inner kernel run
+    EgoImproved,     // inner kernel beat the incumbent
+    EgoCancelled,    // built with a bound above the incumbent, which caught up before solving
+    Count
+};
+
+/// Structures whose size --stats-json reports
+enum class Memory {
+    Graph,           // CSR of the input graph
+    LoadBuffer,      // edge list readFromFile sorts before building the CSR
+    Peel,            // ordering, degenRank, core numbers and the peeling heap
+    Truss,           // edge support, reverse slots and states of the truss pruner
+    EgoScratch,      // per thread included flags, candidates and common neighbour counts
+    SubgraphScratch, // per thread vertex map and edge buffer of subgraphDegen
+    Subgraph,        // CSR of the ego network being solved
+    Hubs,            // bitmap rows of the high degree vertices
+    Count
+};
+
+/// Counters of one thread. Only the owning thread writes to it, so the hot loop needs no
+/// atomics; Stats sums them up at the end.
+struct alignas(64) ThreadStats {
+    std::array<int64_t, size_t(Phase::Count)> phaseNs{};
+    std::array<int64_t, size_t(Counter::Count)> counters{};
+    // ego network sizes, bucket i counts sizes in [2^(i-1), 2^i)
+    std::array<int64_t, 33> egoSizes{};
+    // bytes currently held and the high water mark
+    std::array<int64_t, size_t(Memory::Count)> memBytes{};
+    std::array<int64_t, size_t(Memory::Count)> memPeak{};
+};
+
+/// Per-phase timers and ego loop counters, written out by --stats-json.
+/// Everything is a no-op unless enabled.
+class Stats {
+public:
+    static inline bool enabled = false;
+
+    ThreadStats &local() {
+        thread_local ThreadStats *slot = registerThread();
+        return *slot;
+    }
+    void count(Counter counter, int64_t amount = 1) {
+        if (enabled) { local().counters[size_t(counter)] += amount; }
+    }
+    void egoSize(int64_t size) {
+        if (enabled) { local().egoSizes[std::bit_width(uint64_t(size))]++; }
+    }
+    /// Bytes allocated (or freed, if negative) for a structure by this thread
+    void memory(Memory memory, int64_t bytes) {
+        if (!enabled) { return; }
+        ThreadStats &s = local();
+        int64_t current = s.memBytes[size_t(memory)] += bytes;
+        if (current > s.memPeak[size_t(memory)]) { s.memPeak[size_t(memory)] = current; }
+    }
+
+    /// Top level values of the json document, e.g. program options and the result
+    template<std::integral T>
+        requires(!std::same_as<T, bool>)
+    void set(const std::string &key, T value) {
+        setRaw(key, std::to_string(value));
+    }
+    void set(const std::string &key, double value);
+    void set(const std::string &key, bool value);
+    void set(const std::string &key, const std::string &value);
+    void set(const std::string &key, const char *value) {
+        set(key, std::string(value));
+    }
+    /// A value that is already json, e.g. a nested object
+    void setJson(const std::string &key, std::string encoded) {
+        setRaw(key, std::move(encoded));
+    }
+
+    void writeJson(const std::string &path);
+    /// Peak bytes per structure and the process peak RSS
+    void printMemory(std::ostream &os);
+
+private:
+    ThreadStats *registerThread();
+    void setRaw(const std::string &key, std::string encoded);
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadStats>> threads;
+    // key -> json encoded value, in insertion order
+    std::vector<std::pair<std::string, std::string>> fields;
+};
+
+Stats &stats();
+
+/// Peak resident set size of the process in bytes
+int64_t peakRss();
+
+/// Accounts bytes to a structure until destruction. update() follows a buffer that grows.
+class TrackedBytes {
+public:
+    explicit TrackedBytes(Memory memory, int64_t bytes = 0) : memory(memory) {
+        update(bytes);
+    }
+    ~TrackedBytes() {
+        update(0);
+    }
+    TrackedBytes(const TrackedBytes &) = delete;
+    TrackedBytes &operator=(const TrackedBytes &) = delete;
+    void update(int64_t bytes) {
+        if (bytes == current) { return; }
+        stats().memory(memory, bytes - current);
+        current = bytes;
+    }
+
+private:
+    Memory memory;
+    int64_t current = 0;
+};
+
+/// Adds the time from construction to stop() / destruction to a phase of this thread. Phases
+/// outside the ego loop also go to --trace; the ego loop traces whole ego networks instead.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Phase phase) : phase(phase), running(Stats::enabled || Trace::enabled) {
+        if (running) { start = std::chrono::steady_clock::now(); }
+    }
+    ~PhaseTimer() {
+        stop();
+    }
+    void stop() {
+        if (!running) { return; }
+        running = false;
+        auto end = std::chrono::steady_clock::now();
+        if (Stats::enabled) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+            stats().local().phaseNs[size_t(phase)] += ns.count();
+        }
+        bool egoPhase = phase == Phase::Collect || phase == Phase::Build || phase == Phase::Bound ||
+                        phase == Phase::Solve;
+        if (Trace::enabled && !egoPhase) {
+            trace().complete(phaseName(phase), toNs(start), toNs(end));
+        }
+    }
+
+private:
+    static int64_t toNs(std::chrono::steady_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    Phase phase;
+    bool running;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace gm
+
+#endif // GM_STATS_HPP
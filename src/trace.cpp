@@ -0,0 +1,61 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <string>
+
+#include "util.hpp"
+
+namespace gm {
+
+Trace &trace() {
+    static Trace instance;
+    return instance;
+}
+
+ThreadTrace *Trace::registerThread() {
+    std::lock_guard lock{mutex};
+    threads.push_back(std::make_unique<ThreadTrace>());
+    threads.back()->id = threads.size() - 1;
+    return threads.back().get();
+}
+
+void Trace::writeJson(const std::string &path) {
+    std::lock_guard lock{mutex};
+    std::ofstream out{path};
+    GM_ASSERT(out, "Trace::writeJson: cannot open " + path);
+
+    // timestamps relative to the first event, in microseconds
+    int64_t origin = INT64_MAX;
+    for (const auto &thread : threads) {
+        for (const auto &event : thread->events) { origin = std::min(origin, event.startNs); }
+    }
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    for (const auto &thread : threads) {
+        out << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+            << thread->id << ", \"args\": {\"name\": \"thread " << thread->id << "\"}}";
+        first = false;
+        for (const auto &event : thread->events) {
+            out << ",\n{\"name\": \"" << event.name << "\", \"ph\": \"" << event.phase
+                << "\", \"pid\": 1, \"tid\": " << thread->id
+                << ", \"ts\": " << std::format("{:.3f}", (event.startNs - origin) / 1000.0);
+            if (event.phase == 'X') {
+                out << ", \"dur\": " << std::format("{:.3f}", event.durationNs / 1000.0);
+            }
+            if (event.phase == 'i') { out << ", \"s\": \"g\""; }
+            if (event.u >= 0 || event.size >= 0) {
+                out << ", \"args\": {";
+                if (event.u >= 0) { out << "\"u\": " << event.u << (event.size >= 0 ? ", " : ""); }
+                if (event.size >= 0) { out << "\"size\": " << event.size; }
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+}
+
+} // namespace gm
@@ -0,0 +1,77 @@
+#ifndef GM_TRACE_HPP
+#define GM_TRACE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gm {
+
+struct TraceEvent {
+    const char *name;
+    char phase; // 'X' complete or 'i' instant, as in the trace event format
+    int64_t startNs, durationNs;
+    int64_t u, size; // -1 if not set
+};
+
+/// Events of one thread, appended without locking
+struct ThreadTrace {
+    int id;
+    std::vector<TraceEvent> events;
+};
+
+/// Timeline of the run in Chrome trace event format (--trace), opens in Perfetto or
+/// chrome://tracing. Ego networks shorter than minNs are dropped to keep the overhead
+/// and the file small; incumbent improvements are always kept.
+class Trace {
+public:
+    static inline bool enabled = false;
+    static inline int64_t minNs = 50'000;
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void complete(const char *name, int64_t startNs, int64_t endNs, int64_t u = -1, int64_t size = -1) {
+        local().events.push_back({name, 'X', startNs, endNs - startNs, u, size});
+    }
+    void instant(const char *name, int64_t size) {
+        local().events.push_back({name, 'i', now(), 0, -1, size});
+    }
+    /// One ego network of root u: candidates collected from start, subgraphDegen until built,
+    /// the kernel until solved. built and solved are 0 if it was pruned by size.
+    void ego(int64_t u, int64_t size, int64_t startNs, int64_t collectedNs, int64_t builtNs,
+             int64_t solvedNs) {
+        int64_t endNs = solvedNs ? solvedNs : collectedNs;
+        if (endNs - startNs < minNs) { return; }
+        complete("ego", startNs, endNs, u, size);
+        complete("collect", startNs, collectedNs);
+        if (solvedNs) {
+            complete("subgraphDegen", collectedNs, builtNs);
+            complete("solve", builtNs, solvedNs);
+        }
+    }
+
+    void writeJson(const std::string &path);
+
+private:
+    ThreadTrace &local() {
+        thread_local ThreadTrace *slot = registerThread();
+        return *slot;
+    }
+    ThreadTrace *registerThread();
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadTrace>> threads;
+};
+
+Trace &trace();
+
+} // namespace gm
+
+#endif // GM_TRACE_HPP
@@ -7,6 +7,8 @@
 #include <iostream>
 #include <vector>
 
+#include "stats.hpp"
+
 #define GM_ASSERT(val, message) ((val) ? 0 : (std::cout << (message) << std::endl, std::exit(1), 0))
 
 namespace gm {
@@ -28,9 +30,9 @@ auto printTimer(F func) -> decltype(func()) {
     auto start = std::chrono::high_resolution_clock::now();
     auto r = func();
     auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "[timer] "
-              << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
-              << " microseconds" << std::endl;
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    std::cout << "[timer] " << us << " microseconds" << std::endl;
+    stats().set("runtime_us", us);
     return std::move(r);
 }
 